@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+// runs 'foo' 'iterations' times, returns average time of one call in nanoseconds
+template <typename F>
+double measure_ns(std::size_t iterations, F&& foo) {
+  // warm up
+  for (std::size_t i = 0; i < iterations / 10 + 1; ++i)
+    foo();
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+    foo();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+struct result {
+  std::string name;
+  double value = 0;
+  std::string unit;
+};
+
+// all reported results, dumped as JSON by main if requested
+inline std::vector<result>& results() {
+  static std::vector<result> r;
+  return r;
+}
+
+inline void report(std::string_view name, double value, std::string_view unit = "ns") {
+  std::printf("%-60.*s %12.2f %.*s\n", int(name.size()), name.data(), value, int(unit.size()), unit.data());
+  results().push_back(result{std::string(name), value, std::string(unit)});
+}
+
+inline void report_throughput(std::string_view name, double per_second, std::string_view unit) {
+  report(name, per_second, unit);
+}
+
+// count of operator new calls since program start, see alloc_counter.cpp
+std::size_t allocations_count() noexcept;
+
+// average count of allocations in one call of 'foo'
+template <typename F>
+double measure_allocations(std::size_t iterations, F&& foo) {
+  std::size_t before = allocations_count();
+  for (std::size_t i = 0; i < iterations; ++i)
+    foo();
+  return double(allocations_count() - before) / iterations;
+}
+
+}  // namespace bench
+
+void run_option_lookup_benchmarks();
+void run_distance_benchmarks();
+void run_parse_batch_benchmarks();
+void run_response_file_benchmarks();
+void run_parse_benchmarks();
+void run_tokenize_benchmarks();
+void run_live_options_benchmarks();
+void run_snapshot_benchmarks();
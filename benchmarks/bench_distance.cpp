@@ -0,0 +1,217 @@
+#include <clinok/utils.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace reference {
+
+// implementation before qwerty cost table and bit-parallel lower bound
+
+static double qwerty_cost(char a, char b) {
+  a = std::tolower(a);
+  b = std::tolower(b);
+
+  if (a == b)
+    return 0.0;
+
+  static const std::unordered_map<char, std::pair<int, int>> qwerty_coords = [] {
+    std::unordered_map<char, std::pair<int, int>> m;
+    std::string_view rows[] = {"1234567890", "qwertyuiop", "asdfghjkl", "zxcvbnm"};
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < int(rows[row].size()); ++col)
+        m[rows[row][col]] = {row, col};
+    }
+    return m;
+  }();
+
+  auto it_a = qwerty_coords.find(a);
+  auto it_b = qwerty_coords.find(b);
+
+  if (it_a == qwerty_coords.end() || it_b == qwerty_coords.end())
+    return 1.0;
+
+  const auto& [row_a, col_a] = it_a->second;
+  const auto& [row_b, col_b] = it_b->second;
+
+  double row_diff = row_a - row_b;
+  double col_diff = col_a - col_b;
+  double distance = std::sqrt(row_diff * row_diff + col_diff * col_diff);
+  return distance / 2.0;
+}
+
+static double damerau_levenshtein_distance(std::string_view a, std::string_view b) {
+  const size_t m = a.size();
+  const size_t n = b.size();
+
+  if (m == 0)
+    return n;
+  if (n == 0)
+    return m;
+
+  std::vector<double> prev_prev_row(n + 1);
+  std::vector<double> prev_row(n + 1);
+  std::vector<double> curr_row(n + 1);
+
+  for (size_t i = 0; i <= n; ++i) {
+    prev_row[i] = i;
+  }
+
+  for (size_t i = 1; i <= m; ++i) {
+    curr_row[0] = i;
+
+    for (size_t j = 1; j <= n; ++j) {
+      curr_row[j] =
+          std::min({prev_row[j] + 1, curr_row[j - 1] + 1, prev_row[j - 1] + qwerty_cost(a[i - 1], b[j - 1])});
+
+      if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+        curr_row[j] = std::min(curr_row[j], prev_prev_row[j - 2] + 1);
+      }
+    }
+    auto tmp = std::move(prev_prev_row);
+    prev_prev_row = std::move(prev_row);
+    prev_row = std::move(curr_row);
+    curr_row = std::move(tmp);
+  }
+
+  return prev_row[n];
+}
+
+static clinok::best_match_result_t best_match_str(std::string_view str, auto&& possibles) {
+  clinok::best_match_result_t res;
+  for (std::string_view alt : possibles) {
+    double d = damerau_levenshtein_distance(str, alt);
+    if (d < res.diff) {
+      res.diff = d;
+      res.found = alt;
+    }
+  }
+  return res;
+}
+
+}  // namespace reference
+
+static std::vector<std::string> make_option_names(std::size_t count) {
+  std::vector<std::string> names;
+  const char* kinds[] = {"int", "str", "bool"};
+  for (std::size_t i = 0; i < count; ++i)
+    names.push_back("--opt_" + std::string(kinds[i % 3]) + "_" + std::to_string(i));
+  return names;
+}
+
+// typos of existing names: swapped, replaced and removed chars
+static std::vector<std::string> make_typos(const std::vector<std::string>& names, std::size_t count) {
+  std::mt19937 gen(42);
+  std::vector<std::string> typos;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string s = names[gen() % names.size()];
+    std::size_t pos = 2 + gen() % (s.size() - 3);
+    switch (gen() % 3) {
+      case 0:
+        std::swap(s[pos], s[pos + 1]);
+        break;
+      case 1:
+        s[pos] = 'a' + gen() % 26;
+        break;
+      default:
+        s.erase(pos, 1);
+    }
+    typos.push_back(std::move(s));
+  }
+  return typos;
+}
+
+static bool check_results(const std::vector<std::string>& names, const std::vector<std::string>& typos) {
+  clinok::suggestion_index index(names);
+  for (auto& t : typos) {
+    for (auto& n : names) {
+      if (reference::damerau_levenshtein_distance(t, n) != clinok::damerau_levenshtein_distance(t, n))
+        return false;
+    }
+    auto r1 = reference::best_match_str(t, names);
+    auto r2 = clinok::best_match_str(t, names);
+    if (r1.found != r2.found || r1.diff != r2.diff)
+      return false;
+    clinok::suggestion s[1];
+    if (index.suggest(t, std::numeric_limits<double>::max(), s) != 1 || s[0].str != r1.found)
+      return false;
+  }
+  return true;
+}
+
+void run_distance_benchmarks() {
+  for (std::size_t count : {10, 100, 1000}) {
+    std::vector<std::string> names = make_option_names(count);
+    std::vector<std::string> typos = make_typos(names, 64);
+    if (!check_results(names, typos)) {
+      std::printf("damerau_levenshtein_distance results differ from reference for %zu options\n", count);
+      std::exit(1);
+    }
+    std::string prefix = std::to_string(count) + " options ";
+    std::size_t iterations = 100'000 / count + 1;
+    std::size_t n = 0;
+    bench::report(prefix + "distance, reference", bench::measure_ns(iterations * count, [&] {
+                    bench::do_not_optimize(reference::damerau_levenshtein_distance(
+                        typos[n % typos.size()], names[n % names.size()]));
+                    ++n;
+                  }));
+    n = 0;
+    bench::report(prefix + "distance", bench::measure_ns(iterations * count, [&] {
+                    bench::do_not_optimize(clinok::damerau_levenshtein_distance(typos[n % typos.size()],
+                                                                                names[n % names.size()]));
+                    ++n;
+                  }));
+    n = 0;
+    // lower bound for every candidate, one by one as in best_match_str
+    // and in blocks of same length as in suggestion_index
+    bench::report(prefix + "osa_pattern lower bound", bench::measure_ns(iterations, [&] {
+                    clinok::osa_pattern pattern(typos[n++ % typos.size()]);
+                    std::size_t sum = 0;
+                    for (auto& name : names)
+                      sum += pattern.distance(name);
+                    bench::do_not_optimize(sum);
+                  }));
+    std::vector<std::string_view> sorted_names(names.begin(), names.end());
+    std::ranges::stable_sort(sorted_names, {}, &std::string_view::size);
+    std::vector<std::span<const std::string_view>> blocks;
+    for (auto b = sorted_names.begin(); b != sorted_names.end();) {
+      auto e = b + 1;
+      while (e != sorted_names.end() && e - b < 8 && e->size() == b->size())
+        ++e;
+      blocks.emplace_back(b, e);
+      b = e;
+    }
+    std::size_t bounds[8];
+    n = 0;
+    bench::report(prefix + "osa_pattern lower bound, blocks", bench::measure_ns(iterations, [&] {
+                    clinok::osa_pattern pattern(typos[n++ % typos.size()]);
+                    std::size_t sum = 0;
+                    for (auto block : blocks) {
+                      pattern.distance(block, bounds);
+                      sum += bounds[0];
+                    }
+                    bench::do_not_optimize(sum);
+                  }));
+    n = 0;
+    bench::report(prefix + "best_match_str, reference", bench::measure_ns(iterations, [&] {
+                    bench::do_not_optimize(reference::best_match_str(typos[n++ % typos.size()], names));
+                  }));
+    n = 0;
+    bench::report(prefix + "best_match_str", bench::measure_ns(iterations, [&] {
+                    bench::do_not_optimize(clinok::best_match_str(typos[n++ % typos.size()], names));
+                  }));
+    clinok::suggestion_index index(names);
+    n = 0;
+    bench::report(prefix + "suggestion_index, 1 best", bench::measure_ns(iterations, [&] {
+                    clinok::suggestion s[1];
+                    bench::do_not_optimize(index.suggest(typos[n++ % typos.size()], 5, s));
+                  }));
+  }
+}
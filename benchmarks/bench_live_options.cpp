@@ -0,0 +1,82 @@
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "point.hpp"
+
+#define program_options_file "realistic_options.def"
+#define CLINOK_NAMESPACE_NAME live
+#include <clinok/cli_interface.hpp>
+
+#include <clinok/live_options.hpp>
+
+namespace {
+
+// reads per second of each reader thread during 'duration'
+double measure_reads(clinok::live_options<live::cli_t>& opts, unsigned readers_count,
+                     std::chrono::milliseconds duration) {
+  std::atomic_bool stop = false;
+  std::atomic_size_t total = 0;
+  std::vector<std::thread> readers;
+  for (unsigned i = 0; i < readers_count; ++i) {
+    readers.emplace_back([&] {
+      std::size_t reads = 0;
+      std::int64_t sum = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (int j = 0; j < 64; ++j) {
+          auto r = opts.read();
+          sum += r->options.timeout;
+        }
+        reads += 64;
+      }
+      bench::do_not_optimize(sum);
+      total += reads;
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto& t : readers)
+    t.join();
+  return double(total) / readers_count / std::chrono::duration<double>(duration).count();
+}
+
+}  // namespace
+
+void run_live_options_benchmarks() {
+  std::string path = (std::filesystem::temp_directory_path() / "clinok_bench_live_config").string();
+  std::ofstream(path, std::ios::binary) << "timeout = 10\nuser = admin\norigin = 1 2\n";
+  const char* argv[] = {"program", "--verbose", "true"};
+  clinok::live_options<live::cli_t> opts({.args = clinok::args_t(argv)}, path);
+  clinok::error_code ec;
+  if (!opts.reload(ec))
+    std::abort();
+
+  unsigned readers_count = std::max(2u, std::thread::hardware_concurrency() / 2);
+  auto duration = std::chrono::milliseconds(300);
+  std::string suffix = ", " + std::to_string(readers_count) + " readers, per reader";
+  bench::report_throughput("live_options read without reloads" + suffix,
+                           measure_reads(opts, readers_count, duration) / 1e6, "Mreads/s");
+
+  std::atomic_bool stop = false;
+  std::size_t reloads = 0;
+  std::thread writer([&] {
+    clinok::error_code ec;
+    while (!stop.load()) {
+      reloads += opts.reload(ec);
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+  double reads = measure_reads(opts, readers_count, duration);
+  stop = true;
+  writer.join();
+  bench::report_throughput("live_options read with reloads" + suffix, reads / 1e6, "Mreads/s");
+  bench::report_throughput("live_options reloads during read benchmark",
+                           reloads / std::chrono::duration<double>(duration).count(), "reloads/s");
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,55 @@
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#define program_options_file "options_10.def"
+#define CLINOK_NAMESPACE_NAME opts10
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "options_100.def"
+#define CLINOK_NAMESPACE_NAME opts100
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "options_1000.def"
+#define CLINOK_NAMESPACE_NAME opts1000
+#include <clinok/cli_interface.hpp>
+
+// lookup as it was before perfect hash: compare with each option name
+template <clinok::CLI_like CLI>
+static std::size_t linear_find_option(std::string_view name) {
+  return clinok::apply_to_options<CLI>([&](auto... os) {
+    std::size_t i = 0;
+    (void)((name == clinok::name_of<decltype(os)> || (++i, false)) || ...);
+    return i;
+  });
+}
+
+template <clinok::CLI_like CLI>
+static void bench_lookup(std::string_view cliname) {
+  // all option names and some unknown names
+  std::vector<std::string> names;
+  clinok::for_each_option<CLI>([&]<typename O>(O) { names.emplace_back(clinok::name_of<O>); });
+  std::size_t known = names.size();
+  for (std::size_t i = 0; i < known / 4 + 1; ++i)
+    names.push_back("unknown_" + std::to_string(i));
+
+  constexpr std::size_t iterations = 1'000'000;
+  std::size_t n = 0;
+  double linear = bench::measure_ns(iterations, [&] {
+    bench::do_not_optimize(linear_find_option<CLI>(names[n++ % names.size()]));
+  });
+  n = 0;
+  double hashed = bench::measure_ns(iterations, [&] {
+    bench::do_not_optimize(clinok::find_option<CLI>(names[n++ % names.size()]));
+  });
+  std::string prefix = std::string(cliname) + " option lookup, ";
+  bench::report(prefix + "linear", linear);
+  bench::report(prefix + "perfect hash", hashed);
+}
+
+void run_option_lookup_benchmarks() {
+  bench_lookup<opts10::cli_t>("10 options");
+  bench_lookup<opts100::cli_t>("100 options");
+  bench_lookup<opts1000::cli_t>("1000 options");
+}
@@ -0,0 +1,536 @@
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if __has_include(<getopt.h>)
+  #include <getopt.h>
+  #define CLINOK_BENCH_HAS_GETOPT
+#endif
+
+#include "bench.hpp"
+#include "point.hpp"
+
+#define program_options_file "options_10.def"
+#define CLINOK_NAMESPACE_NAME parse10
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "options_100.def"
+#define CLINOK_NAMESPACE_NAME parse100
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "options_1000.def"
+#define CLINOK_NAMESPACE_NAME parse1000
+#include <clinok/cli_interface.hpp>
+
+#ifdef CLINOK_BENCH_10000_OPTIONS
+  #define program_options_file "options_10000.def"
+  #define CLINOK_NAMESPACE_NAME parse10000
+  #include <clinok/cli_interface.hpp>
+#endif
+
+// aliases, enums, Point options and free args
+#define program_options_file "realistic_options.def"
+#define CLINOK_NAMESPACE_NAME realistic
+#include <clinok/cli_interface.hpp>
+
+// same options parsed by table-driven backend
+#define program_options_file "options_100.def"
+#define CLINOK_NAMESPACE_NAME parse100_table
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "options_1000.def"
+#define CLINOK_NAMESPACE_NAME parse1000_table
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "realistic_options.def"
+#define CLINOK_NAMESPACE_NAME realistic_table
+#include <clinok/cli_interface.hpp>
+
+template <>
+constexpr inline bool clinok::table_driven_parse<parse100_table::cli_t> = true;
+template <>
+constexpr inline bool clinok::table_driven_parse<parse1000_table::cli_t> = true;
+template <>
+constexpr inline bool clinok::table_driven_parse<realistic_table::cli_t> = true;
+
+#define program_options_file "free_args_options.def"
+#define CLINOK_NAMESPACE_NAME free_args
+#include <clinok/cli_interface.hpp>
+
+#define program_options_file "free_args_view_options.def"
+#define CLINOK_NAMESPACE_NAME free_args_view
+#include <clinok/cli_interface.hpp>
+
+namespace {
+
+// command lines with stable pointers to arguments
+struct cmdlines_t {
+  std::vector<std::vector<std::string>> strs;
+  std::vector<std::vector<clinok::arg>> argvs;
+  std::size_t args_count = 0;  // without program names
+
+  void add(std::vector<std::string> cmdline) {
+    std::vector<clinok::arg>& argv = argvs.emplace_back();
+    std::vector<std::string>& s = strs.emplace_back(std::move(cmdline));
+    for (std::string& a : s)
+      argv.push_back(a.c_str());
+    args_count += s.size() - 1;
+  }
+  std::size_t size() const noexcept {
+    return argvs.size();
+  }
+  clinok::args_t operator[](std::size_t i) const noexcept {
+    return argvs[i];
+  }
+};
+
+constexpr std::size_t cmdlines_count = 1024;
+
+// options of generated options files, see CMakeLists.txt
+template <clinok::CLI_like CLI>
+cmdlines_t generate_cmdlines() {
+  std::vector<std::string> names;
+  clinok::for_each_option<CLI>([&]<typename O>(O) { names.emplace_back(clinok::name_of<O>); });
+  names.pop_back();  // help
+
+  std::mt19937 gen(42);
+  cmdlines_t res;
+  for (std::size_t n = 0; n < cmdlines_count; ++n) {
+    std::vector<std::string> cmdline = {"program"};
+    std::size_t opts_count = 1 + gen() % 8;
+    for (std::size_t j = 0; j < opts_count; ++j) {
+      std::string& name = names[gen() % names.size()];
+      cmdline.push_back("--" + name);
+      if (name.starts_with("opt_int_"))
+        cmdline.push_back(std::to_string(gen() % 1000));
+      else if (name.starts_with("opt_str_"))
+        cmdline.push_back("value" + std::to_string(j));
+      else
+        cmdline.push_back(gen() % 2 ? "true" : "off");
+    }
+    res.add(std::move(cmdline));
+  }
+  return res;
+}
+
+cmdlines_t generate_realistic_cmdlines() {
+  // each entry is an option with its arguments as user may type it
+  const std::vector<std::vector<std::string>> parts = {
+      {"--verbose", "true"},
+      {"-v", "on"},
+      {"--debug", "0"},
+      {"--version"},
+      {"--output", "build/result.bin"},
+      {"-o", "a.out"},
+      {"--user", "alice"},
+      {"-u", "bob"},
+      {"--config", "/etc/program/config.toml"},
+      {"--color", "blue"},
+      {"-c", "yellow"},
+      {"--log-level", "warn"},
+      {"--retries", "5"},
+      {"--timeout", "120"},
+      {"-j", "16"},
+      {"--origin", "10", "-20"},
+      {"--size", "1920", "1080"},
+      {"src/main.cpp"},
+      {"src/lib/file.cpp"},
+  };
+  std::mt19937 gen(42);
+  cmdlines_t res;
+  for (std::size_t n = 0; n < cmdlines_count; ++n) {
+    std::vector<std::string> cmdline = {"program"};
+    std::size_t parts_count = 1 + gen() % 10;
+    for (std::size_t j = 0; j < parts_count; ++j) {
+      auto& p = parts[gen() % parts.size()];
+      cmdline.insert(cmdline.end(), p.begin(), p.end());
+    }
+    res.add(std::move(cmdline));
+  }
+  return res;
+}
+
+template <clinok::CLI_like CLI>
+void bench_parse(std::string_view cliname, const cmdlines_t& cmdlines) {
+  std::string prefix = std::string(cliname) + " parse, ";
+  constexpr std::size_t iterations = 200'000;
+  std::size_t n = 0;
+  double ns = bench::measure_ns(iterations, [&] {
+    clinok::error_code ec;
+    auto o = clinok::parse<CLI>(cmdlines[n++ % cmdlines.size()], ec);
+    bench::do_not_optimize(o);
+    bench::do_not_optimize(ec);
+  });
+  double args_per_cmdline = double(cmdlines.args_count) / cmdlines.size();
+  bench::report(prefix + "per cmdline", ns);
+  bench::report(prefix + "per arg", ns / args_per_cmdline, "ns/arg");
+  n = 0;
+  bench::report(prefix + "allocations", bench::measure_allocations(cmdlines.size(), [&] {
+                  clinok::error_code ec;
+                  auto o = clinok::parse<CLI>(cmdlines[n++], ec);
+                  bench::do_not_optimize(o);
+                }),
+                "allocs/cmdline");
+}
+
+// reuses options struct between calls
+template <clinok::CLI_like CLI>
+void bench_parse_into(std::string_view cliname, const cmdlines_t& cmdlines) {
+  std::string prefix = std::string(cliname) + " parse_into, ";
+  typename CLI::options opts = clinok::default_options<CLI>();
+  typename CLI::presented_options presented;
+  clinok::error_code ec;
+  constexpr std::size_t iterations = 200'000;
+  std::size_t n = 0;
+  double ns = bench::measure_ns(iterations, [&] {
+    clinok::parse_into<CLI>(opts, presented, cmdlines[n++ % cmdlines.size()], ec);
+    bench::do_not_optimize(opts);
+  });
+  double args_per_cmdline = double(cmdlines.args_count) / cmdlines.size();
+  bench::report(prefix + "per arg", ns / args_per_cmdline, "ns/arg");
+  n = 0;
+  bench::report(prefix + "allocations", bench::measure_allocations(cmdlines.size(), [&] {
+                  clinok::parse_into<CLI>(opts, presented, cmdlines[n++], ec);
+                  bench::do_not_optimize(opts);
+                }),
+                "allocs/cmdline");
+}
+
+// visits all options without materializing options struct
+template <clinok::CLI_like CLI>
+void bench_pull_parser(std::string_view cliname, const cmdlines_t& cmdlines) {
+  constexpr std::size_t iterations = 200'000;
+  std::size_t n = 0;
+  double ns = bench::measure_ns(iterations, [&] {
+    clinok::pull_parser<CLI> parser(cmdlines[n++ % cmdlines.size()]);
+    clinok::parse_event e;
+    std::size_t count = 0;
+    while (parser.next(e))
+      ++count;
+    bench::do_not_optimize(count);
+  });
+  double args_per_cmdline = double(cmdlines.args_count) / cmdlines.size();
+  bench::report(std::string(cliname) + " pull_parser, per arg", ns / args_per_cmdline, "ns/arg");
+}
+
+#ifdef CLINOK_BENCH_HAS_GETOPT
+
+// getopt_long for same options, only finds options and arguments without converting values.
+// Options with several arguments (Point) take one argument, others are permuted as free args
+template <clinok::CLI_like CLI>
+void bench_getopt_long(std::string_view cliname, const cmdlines_t& cmdlines) {
+  std::vector<option> longopts;
+  clinok::for_each_option<CLI>([&]<typename O>(O) {
+    // names are string literals, so null terminated
+    longopts.push_back(option{clinok::name_of<O>.data(),
+                              clinok::is_tag_option<O>() ? no_argument : required_argument, nullptr,
+                              int(256 + longopts.size())});
+  });
+  longopts.push_back(option{});
+  std::string shortopts = "-";  // return free args in order, as clinok does
+  for (auto [a, _] : CLI::aliases) {
+    if (a.size() != 1)
+      continue;
+    shortopts += a;
+    bool tag = false;
+    clinok::visit_option_by_index<CLI>(clinok::find_alias<CLI>(a),
+                                       [&]<typename O>(O) { tag = clinok::is_tag_option<O>(); });
+    if (!tag)
+      shortopts += ':';
+  }
+
+  std::vector<const char*> argv;
+  std::vector<const char*> values(longopts.size());
+  constexpr std::size_t iterations = 200'000;
+  std::size_t n = 0;
+  double ns = bench::measure_ns(iterations, [&] {
+    clinok::args_t args = cmdlines[n++ % cmdlines.size()];
+    argv.assign(args.begin(), args.end());
+    argv.push_back(nullptr);
+    optind = 0;  // reinitialize getopt
+    opterr = 0;
+    std::size_t free_args = 0;
+    for (int c; (c = getopt_long(int(args.size()), const_cast<char**>(argv.data()), shortopts.c_str(),
+                                 longopts.data(), nullptr)) != -1;) {
+      if (c >= 256)
+        values[c - 256] = optarg;
+      else if (c == 1)
+        ++free_args;
+      else if (char alias = char(c); c != '?')
+        values[clinok::find_alias<CLI>(std::string_view(&alias, 1))] = optarg;
+    }
+    bench::do_not_optimize(values.data());
+    bench::do_not_optimize(free_args);
+  });
+  double args_per_cmdline = double(cmdlines.args_count) / cmdlines.size();
+  std::string prefix = std::string(cliname) + " getopt_long (no value conversion), ";
+  bench::report(prefix + "per cmdline", ns);
+  bench::report(prefix + "per arg", ns / args_per_cmdline, "ns/arg");
+}
+
+#else
+
+template <clinok::CLI_like CLI>
+void bench_getopt_long(std::string_view, const cmdlines_t&) {
+}
+
+#endif
+
+template <clinok::CLI_like CLI>
+void bench_parse_and_baseline(std::string_view cliname, const cmdlines_t& cmdlines) {
+  bench_parse<CLI>(cliname, cmdlines);
+  bench_parse_into<CLI>(cliname, cmdlines);
+  bench_pull_parser<CLI>(cliname, cmdlines);
+  bench_getopt_long<CLI>(cliname, cmdlines);
+}
+
+// parse which fails and formatting of error message
+template <clinok::CLI_like CLI>
+void bench_error_path(std::string_view name, std::vector<clinok::arg> argv) {
+  constexpr std::size_t iterations = 20'000;
+  std::string prefix = std::string(name) + ", ";
+  clinok::error_code ec;
+  bench::report(prefix + "parse", bench::measure_ns(iterations, [&] {
+                  ec.clear();
+                  auto o = clinok::parse<CLI>(argv, ec);
+                  bench::do_not_optimize(o);
+                }));
+  std::string msg;
+  bench::report(prefix + "print_err_to", bench::measure_ns(iterations, [&] {
+                  msg.clear();
+                  clinok::print_err_to<CLI>(ec, [&](auto&& x) { msg += x; });
+                  bench::do_not_optimize(msg);
+                }));
+}
+
+template <clinok::CLI_like CLI>
+void bench_help(std::string_view cliname) {
+  std::string msg;
+  bench::report(std::string(cliname) + " print_help_message_to", bench::measure_ns(2'000, [&] {
+                  msg.clear();
+                  clinok::print_help_message_to<CLI>([&](auto&& x) { msg += x; });
+                  bench::do_not_optimize(msg);
+                }));
+}
+
+void bench_resolve_alias() {
+  using CLI = realistic::cli_t;
+  std::vector<std::string> names;
+  for (auto [a, _] : CLI::aliases)
+    names.emplace_back(a);
+  names.push_back("unknown");
+  std::size_t n = 0;
+  bench::report("realistic resolve_alias", bench::measure_ns(1'000'000, [&] {
+                  bench::do_not_optimize(clinok::resolve_alias<CLI>(names[n++ % names.size()]));
+                }));
+}
+
+// ninja style: options first, then many files
+template <clinok::CLI_like CLI>
+void bench_free_args(std::string_view name, std::size_t count) {
+  std::vector<std::string> strs;
+  for (std::size_t i = 0; i < count; ++i)
+    strs.push_back("src/file_" + std::to_string(i) + ".cpp");
+  std::vector<clinok::arg> argv = {"program", "--output", "result.txt", "--verbose"};
+  for (auto& s : strs)
+    argv.push_back(s.c_str());
+
+  auto foo = [&] {
+    clinok::error_code ec;
+    typename CLI::options o = clinok::parse<CLI>(clinok::args_t(argv), ec);
+    bench::do_not_optimize(o.additional_args.size());
+  };
+  std::string prefix = std::string(name) + ' ' + std::to_string(count) + " free args";
+  bench::report(prefix + ", parse", bench::measure_ns(20, foo));
+  bench::report(prefix + ", allocations", bench::measure_allocations(5, foo), "allocs");
+}
+
+// config file + environment + command line, compared with building synthetic argv from them
+void bench_layered() {
+  using CLI = realistic::cli_t;
+  std::string path = (std::filesystem::temp_directory_path() / "clinok_bench_config").string();
+  std::ofstream(path, std::ios::binary) << "# realistic config\n"
+                                           "verbose = true\n"
+                                           "output = \"build/output file.txt\"\n"
+                                           "user = admin\n"
+                                           "color = blue\n"
+                                           "log-level = debug\n"
+                                           "retries = 5\n"
+                                           "origin = 10 20\n"
+                                           "size = 1920 1080\n"
+                                           "[other]\n"
+                                           "jobs = 100\n";
+  const char* env[] = {"HOME=/home/user", "PATH=/usr/bin:/bin", "APP_TIMEOUT=60", "APP_JOBS=8",
+                       "LANG=C.UTF-8",    nullptr};
+  const char* argv[] = {"program", "--debug", "true", "a.txt"};
+  clinok::args_t args(argv);
+
+  auto layered = [&] {
+    clinok::config_file config;
+    if (!config.open(path.c_str()))
+      std::abort();
+    clinok::error_code ec;
+    clinok::layered_sources src{.args = args, .env = env, .env_prefix = "APP_", .config = &config};
+    auto o = clinok::parse_layered<CLI>(src, ec);
+    bench::do_not_optimize(o.timeout);
+  };
+  bench::report("layered config + env + args, parse_layered", bench::measure_ns(10'000, layered));
+  {
+    clinok::config_file config;
+    bench::report("layered config_file::open", bench::measure_ns(10'000, [&] {
+                    if (!config.open(path.c_str()))
+                      std::abort();
+                  }));
+    bench::report("layered parse_layered with loaded config", bench::measure_ns(10'000, [&] {
+                    clinok::error_code ec;
+                    auto o = clinok::parse_layered<CLI>(
+                        {.args = args, .env = env, .env_prefix = "APP_", .config = &config}, ec);
+                    bench::do_not_optimize(o.timeout);
+                  }));
+  }
+  bench::report("layered config + env + args, parse_layered allocations",
+                bench::measure_allocations(100, layered), "allocs");
+
+  auto glue = [&] {
+    std::ifstream f(path);
+    std::vector<std::string> strs = {"program"};
+    for (std::string line; std::getline(f, line);) {
+      if (line.empty() || line[0] == '#')
+        continue;
+      if (line[0] == '[')
+        break;
+      auto eq = line.find('=');
+      strs.push_back("--" + line.substr(0, eq - 1));
+      std::string value = line.substr(eq + 2);
+      if (value.front() == '"')
+        strs.push_back(value.substr(1, value.size() - 2));
+      else
+        for (std::size_t b = 0, e; b != value.npos; b = e == value.npos ? e : e + 1)
+          strs.push_back(value.substr(b, (e = value.find(' ', b)) - b));
+    }
+    for (const char* const* e = env; *e; ++e) {
+      std::string var = *e;
+      if (!var.starts_with("APP_"))
+        continue;
+      auto eq = var.find('=');
+      std::string name = var.substr(4, eq - 4);
+      for (char& c : name)
+        c = c == '_' ? '-' : std::tolower(c);
+      strs.push_back("--" + name);
+      strs.push_back(var.substr(eq + 1));
+    }
+    for (auto a : args.subspan(1))
+      strs.push_back(a);
+    std::vector<clinok::arg> argv2;
+    for (auto& s : strs)
+      argv2.push_back(s.c_str());
+    clinok::error_code ec;
+    auto o = clinok::parse<CLI>(clinok::args_t(argv2), ec);
+    bench::do_not_optimize(o.timeout);
+  };
+  bench::report("layered config + env + args, synthetic argv", bench::measure_ns(10'000, glue));
+  bench::report("layered config + env + args, synthetic argv allocations",
+                bench::measure_allocations(100, glue), "allocs");
+  std::filesystem::remove(path);
+}
+
+// re-emission of parsed realistic command lines, compared with building std::string per argument
+void bench_to_args() {
+  using CLI = realistic::cli_t;
+  cmdlines_t cmdlines = generate_realistic_cmdlines();
+  std::vector<realistic::options> opts;
+  std::vector<CLI::presented_options> presented(cmdlines.size());
+  for (std::size_t i = 0; i < cmdlines.size(); ++i) {
+    clinok::error_code ec;
+    opts.push_back(clinok::parse<CLI>(cmdlines[i], presented[i], ec));
+    if (ec)
+      std::abort();
+  }
+  std::vector<char> chars(64 * 1024);
+  std::vector<clinok::arg> args(1024);
+  std::size_t i = 0;
+  auto all = [&] {
+    clinok::args_writer w(chars, args);
+    if (!clinok::to_args<CLI>("program", opts[i++ % opts.size()], w))
+      std::abort();
+    bench::do_not_optimize(w.args().size());
+  };
+  auto only_presented = [&] {
+    clinok::args_writer w(chars, args);
+    std::size_t j = i++ % opts.size();
+    if (!clinok::to_args<CLI>("program", opts[j], presented[j], w))
+      std::abort();
+    bench::do_not_optimize(w.args().size());
+  };
+  auto strings = [&] {
+    const realistic::options& o = opts[i++ % opts.size()];
+    std::vector<std::string> strs = {"program"};
+    auto add = [&](std::string name, std::string value) {
+      strs.push_back("--" + name);
+      strs.push_back(std::move(value));
+    };
+    add("verbose", o.verbose ? "true" : "false");
+    add("debug", o.debug ? "true" : "false");
+    add("output", std::string(o.output));
+    add("user", std::string(o.user));
+    add("config", std::string(o.config));
+    add("color", std::string(realistic::e2str(o.color)));
+    add("log-level", std::string(realistic::e2str(o.log_level)));
+    add("retries", std::to_string(o.retries));
+    add("timeout", std::to_string(o.timeout));
+    add("jobs", std::to_string(o.jobs));
+    add("origin", std::to_string(o.origin.x));
+    strs.push_back(std::to_string(o.origin.y));
+    add("size", std::to_string(o.size.x));
+    strs.push_back(std::to_string(o.size.y));
+    for (std::string_view a : o.additional_args)
+      strs.emplace_back(a);
+    std::vector<clinok::arg> argv;
+    for (auto& s : strs)
+      argv.push_back(s.c_str());
+    argv.push_back(nullptr);
+    bench::do_not_optimize(argv.size());
+  };
+  bench::report("realistic to_args all options", bench::measure_ns(100'000, all));
+  bench::report("realistic to_args presented options", bench::measure_ns(100'000, only_presented));
+  bench::report("realistic std::string per argument", bench::measure_ns(100'000, strings));
+  bench::report("realistic to_args all options allocations", bench::measure_allocations(1000, all),
+                "allocs");
+  bench::report("realistic std::string per argument allocations", bench::measure_allocations(1000, strings),
+                "allocs");
+}
+
+}  // namespace
+
+void run_parse_benchmarks() {
+  bench_parse_and_baseline<parse10::cli_t>("10 options", generate_cmdlines<parse10::cli_t>());
+  bench_parse_and_baseline<parse100::cli_t>("100 options", generate_cmdlines<parse100::cli_t>());
+  bench_parse_and_baseline<parse1000::cli_t>("1000 options", generate_cmdlines<parse1000::cli_t>());
+#ifdef CLINOK_BENCH_10000_OPTIONS
+  bench_parse_and_baseline<parse10000::cli_t>("10000 options", generate_cmdlines<parse10000::cli_t>());
+#endif
+  bench_parse_and_baseline<realistic::cli_t>("realistic", generate_realistic_cmdlines());
+
+  bench_parse<parse100_table::cli_t>("100 options table", generate_cmdlines<parse100_table::cli_t>());
+  bench_parse<parse1000_table::cli_t>("1000 options table", generate_cmdlines<parse1000_table::cli_t>());
+  bench_parse<realistic_table::cli_t>("realistic table", generate_realistic_cmdlines());
+
+  bench_error_path<realistic::cli_t>("realistic unknown option", {"program", "--verbos", "true"});
+  bench_error_path<realistic::cli_t>("realistic unknown alias", {"program", "-x", "true"});
+  bench_error_path<realistic::cli_t>("realistic invalid enum value", {"program", "--color", "purple"});
+  bench_error_path<realistic::cli_t>("realistic not a number", {"program", "--retries", "many"});
+  bench_error_path<parse1000::cli_t>("1000 options unknown option", {"program", "--opt_int_5x", "1"});
+
+  bench_help<realistic::cli_t>("realistic");
+  bench_help<parse1000::cli_t>("1000 options");
+  bench_resolve_alias();
+  bench_layered();
+  bench_to_args();
+
+  bench_free_args<free_args::cli_t>("vector", 100'000);
+  bench_free_args<free_args_view::cli_t>("view", 100'000);
+}
@@ -0,0 +1,58 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#define program_options_file "options_100.def"
+#define CLINOK_NAMESPACE_NAME batch100
+#include <clinok/cli_interface.hpp>
+
+void run_parse_batch_benchmarks() {
+  using cli_t = batch100::cli_t;
+  std::vector<std::string> names;
+  clinok::for_each_option<cli_t>(
+      [&]<typename O>(O) { names.push_back("--" + std::string(clinok::name_of<O>)); });
+  names.pop_back();  // help
+
+  constexpr std::size_t cmdlines_count = 200'000;
+  std::mt19937 gen(42);
+  std::vector<std::string> storage;
+  storage.reserve(cmdlines_count * 20);
+  std::vector<std::vector<clinok::arg>> argvs(cmdlines_count);
+  for (auto& argv : argvs) {
+    argv.push_back("program");
+    std::size_t opts_count = 1 + gen() % 8;
+    for (std::size_t j = 0; j < opts_count; ++j) {
+      std::size_t i = gen() % names.size();
+      argv.push_back(names[i].c_str());
+      // option kinds, see options file generation in CMakeLists.txt
+      switch (i % 3) {
+        case 0:
+          argv.push_back(storage.emplace_back(std::to_string(gen() % 1000)).c_str());
+          break;
+        case 1:
+          argv.push_back(storage.emplace_back("value" + std::to_string(j)).c_str());
+          break;
+        default:
+          argv.push_back(gen() % 2 ? "true" : "off");
+      }
+    }
+  }
+  std::vector<clinok::args_t> args;
+  for (auto& argv : argvs)
+    args.push_back(clinok::args_t(argv));
+
+  std::vector<cli_t::options> opts(cmdlines_count);
+  std::vector<cli_t::presented_options> presented(cmdlines_count);
+  std::vector<clinok::error_code> errs(cmdlines_count);
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    double ns =
+        bench::measure_ns(5, [&] { clinok::parse_batch<cli_t>(args, opts, presented, errs, threads); });
+    bench::report_throughput("parse_batch, 100 options, " + std::to_string(threads) + " threads",
+                             cmdlines_count / (ns / 1e9), "cmdlines/s");
+    if (threads == max_threads)
+      break;
+  }
+}
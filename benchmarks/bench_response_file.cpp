@@ -0,0 +1,59 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#define program_options_file "response_file_options.def"
+#define CLINOK_NAMESPACE_NAME rsp
+#include <clinok/cli_interface.hpp>
+
+void run_response_file_benchmarks() {
+  constexpr std::size_t args_count = 1'000'000;
+  std::string path = (std::filesystem::temp_directory_path() / "clinok_bench_response_file").string();
+  {
+    std::ofstream f(path, std::ios::binary);
+    for (std::size_t i = 0; i < args_count; ++i) {
+      if (i % 1000 == 0)
+        f << "--shard " << i / 1000 << '\n';
+      else
+        f << "src/file_" << i << ".cpp\n";
+    }
+  }
+  std::string at_path = "@" + path;
+  const char* argv[] = {"program", at_path.c_str(), "--output", "result.txt"};
+
+  double ns = bench::measure_ns(3, [&] {
+    clinok::error_code ec;
+    rsp::options o = rsp::parse(clinok::args_range(4, argv), ec);
+    bench::do_not_optimize(o.additional_args.size());
+  });
+  bench::report("1M args from response file, parse", ns);
+  bench::report("1M args from response file, parse per arg", ns / args_count);
+
+  ns = bench::measure_ns(3, [&] {
+    clinok::response_file_reader reader(path.c_str());
+    std::size_t count = 0;
+    for (std::string_view a; reader.next(a);)
+      ++count;
+    bench::do_not_optimize(count);
+  });
+  bench::report("1M args from response file, streaming read", ns);
+
+  // owned strings, as naive implementation does
+  ns = bench::measure_ns(3, [&] {
+    std::ifstream f(path, std::ios::binary);
+    std::vector<std::string> strs;
+    for (std::string s; f >> s;)
+      strs.push_back(std::move(s));
+    std::vector<clinok::arg> args = {"program"};
+    for (auto& s : strs)
+      args.push_back(s.c_str());
+    clinok::error_code ec;
+    rsp::options o = rsp::parse(clinok::args_t(args), ec);
+    bench::do_not_optimize(o.additional_args.size());
+  });
+  bench::report("1M args from ifstream into strings, parse", ns);
+  std::filesystem::remove(path);
+}
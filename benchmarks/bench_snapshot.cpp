@@ -0,0 +1,76 @@
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "point.hpp"
+
+#define program_options_file "realistic_options.def"
+#define CLINOK_NAMESPACE_NAME snap
+#include <clinok/cli_interface.hpp>
+
+#include <clinok/snapshot.hpp>
+
+template <>
+constexpr inline bool clinok::snapshot_restorable<Point> = true;
+
+// worker startup: parsing config, environment and command line vs restoring snapshot of parent
+void run_snapshot_benchmarks() {
+  using CLI = snap::cli_t;
+  std::string path = (std::filesystem::temp_directory_path() / "clinok_bench_snapshot_config").string();
+  std::ofstream(path, std::ios::binary) << "verbose = true\n"
+                                           "output = \"build/output file.txt\"\n"
+                                           "user = admin\n"
+                                           "color = blue\n"
+                                           "log-level = debug\n"
+                                           "retries = 5\n"
+                                           "origin = 10 20\n"
+                                           "size = 1920 1080\n";
+  const char* env[] = {"HOME=/home/user", "PATH=/usr/bin:/bin", "APP_TIMEOUT=60", "APP_JOBS=8", nullptr};
+  const char* argv[] = {"program", "--debug", "true", "a.txt", "b.txt"};
+  clinok::args_t args(argv);
+
+  auto layered = [&] {
+    clinok::config_file config;
+    if (!config.open(path.c_str()))
+      std::abort();
+    clinok::error_code ec;
+    auto o =
+        clinok::parse_layered<CLI>({.args = args, .env = env, .env_prefix = "APP_", .config = &config}, ec);
+    bench::do_not_optimize(o.timeout);
+  };
+  bench::report("snapshot baseline: config + env + args parse_layered", bench::measure_ns(10'000, layered));
+
+  clinok::config_file config;
+  if (!config.open(path.c_str()))
+    std::abort();
+  clinok::error_code ec;
+  CLI::presented_options presented;
+  clinok::option_sources<CLI> sources;
+  snap::options parsed = clinok::parse_layered<CLI>(
+      {.args = args, .env = env, .env_prefix = "APP_", .config = &config}, presented, sources, ec);
+  if (ec)
+    std::abort();
+  std::vector<char> snapshot = clinok::save_snapshot<CLI>(parsed, presented);
+  bench::report("snapshot size", snapshot.size(), "bytes");
+  bench::report("snapshot save", bench::measure_ns(100'000, [&] {
+                  std::size_t written;
+                  (void)clinok::save_snapshot<CLI>(parsed, presented, snapshot, written);
+                  bench::do_not_optimize(written);
+                }));
+
+  auto restore = [&] {
+    snap::options o;
+    CLI::presented_options p;
+    if (clinok::restore_snapshot<CLI>(snapshot, o, p) != clinok::snapshot_errc::ok)
+      std::abort();
+    bench::do_not_optimize(o.timeout);
+  };
+  bench::report("snapshot restore", bench::measure_ns(100'000, restore));
+  bench::report("snapshot restore allocations", bench::measure_allocations(100, restore), "allocs");
+  bench::report("snapshot baseline allocations", bench::measure_allocations(100, layered), "allocs");
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,91 @@
+
+#include <string>
+#include <vector>
+
+#include <clinok/utils.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+// same rules as split_command_line, but builds owned strings char by char
+std::vector<std::string> naive_split(const std::string& cmd) {
+  std::vector<std::string> result;
+  std::string cur;
+  bool in_arg = false;
+  for (std::size_t i = 0; i < cmd.size(); ++i) {
+    char c = cmd[i];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      if (in_arg)
+        result.push_back(std::move(cur));
+      cur.clear();
+      in_arg = false;
+      continue;
+    }
+    in_arg = true;
+    if (c == '\'') {
+      for (++i; i < cmd.size() && cmd[i] != '\''; ++i)
+        cur += cmd[i];
+    } else if (c == '"') {
+      for (++i; i < cmd.size() && cmd[i] != '"'; ++i) {
+        if (cmd[i] == '\\' && i + 1 < cmd.size() && std::string_view("$`\"\\").find(cmd[i + 1]) != cmd.npos)
+          ++i;
+        cur += cmd[i];
+      }
+    } else if (c == '\\' && i + 1 < cmd.size()) {
+      cur += cmd[++i];
+    } else {
+      cur += c;
+    }
+  }
+  if (in_arg)
+    result.push_back(std::move(cur));
+  return result;
+}
+
+}  // namespace
+
+void run_tokenize_benchmarks() {
+  std::string cmd;
+  std::size_t args_count = 0;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    if (i % 4 == 0)
+      cmd += "--output \"build/output dir/file_" + std::to_string(i) + ".o\" ";
+    else if (i % 4 == 1)
+      cmd += "'-DVALUE=\"" + std::to_string(i) + "\"' ";
+    else
+      cmd += "src/very/long/path/to/the/source/file_" + std::to_string(i) + ".cpp ";
+    args_count += i % 4 == 0 ? 2 : 1;
+  }
+
+  std::string buf;
+  std::vector<clinok::arg> out(cmd.size() / 2 + 1);
+  double ns = bench::measure_ns(1000, [&] {
+    // unescaping is in place, so each iteration works on fresh copy. Capacity is reused
+    buf.assign(cmd);
+    clinok::split_result r = clinok::split_command_line(buf.data(), buf.size(), out);
+    bench::do_not_optimize(r.count);
+  });
+  bench::report("split_command_line, per arg", ns / args_count);
+  bench::report("split_command_line, throughput", cmd.size() / ns * 1e9 / (1 << 20), "MiB/s");
+  bench::report("split_command_line, allocations", bench::measure_allocations(100, [&] {
+                  buf.assign(cmd);
+                  bench::do_not_optimize(clinok::split_command_line(buf.data(), buf.size(), out).count);
+                }),
+                "allocs");
+
+  ns = bench::measure_ns(1000, [&] {
+    std::vector<std::string> strs = naive_split(cmd);
+    std::vector<clinok::arg> args;
+    for (auto& s : strs)
+      args.push_back(s.c_str());
+    bench::do_not_optimize(args.size());
+  });
+  bench::report("naive std::string split, per arg", ns / args_count);
+  bench::report("naive std::string split, throughput", cmd.size() / ns * 1e9 / (1 << 20), "MiB/s");
+  bench::report("naive std::string split, allocations", bench::measure_allocations(100, [&] {
+                  std::vector<std::string> strs = naive_split(cmd);
+                  bench::do_not_optimize(strs.size());
+                }),
+                "allocs");
+}
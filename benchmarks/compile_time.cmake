@@ -0,0 +1,97 @@
+# measures compile time of one translation unit with generated parser as options count grows:
+# full cli_interface.hpp, full cli_interface.hpp with precompiled cli.hpp and cli_declarations.hpp only.
+# Also compares object size of generated and table-driven (TABLE_DRIVEN_PARSE) parser.
+# Usage: cmake -DCXX=<compiler> -DCXX_ID=<GNU|Clang> "-DFLAGS=<flags>" -DINCLUDE_DIR=<clinok include dir>
+#              -DWORK_DIR=<dir with options_N.def files> -DCOUNTS=100,1000 -P compile_time.cmake
+
+separate_arguments(flags NATIVE_COMMAND "${FLAGS}")
+list(APPEND flags -std=c++20 -I "${INCLUDE_DIR}" -I "${WORK_DIR}")
+string(REPLACE "," ";" COUNTS "${COUNTS}")
+
+function(now_us out)
+  string(TIMESTAMP t "%s%f" UTC)
+  set(${out} ${t} PARENT_SCOPE)
+endfunction()
+
+# same format as bench::report
+function(report name us)
+  math(EXPR ms "${us} / 1000")
+  math(EXPR frac "(${us} % 1000) / 10")
+  if (frac LESS 10)
+    set(frac "0${frac}")
+  endif()
+  string(LENGTH "${name}" len)
+  math(EXPR pad "60 - ${len}")
+  string(REPEAT " " ${pad} spaces)
+  string(LENGTH "${ms}" len)
+  math(EXPR pad "9 - ${len}")
+  string(REPEAT " " ${pad} ms_spaces)
+  message("${name}${spaces} ${ms_spaces}${ms}.${frac} ms")
+endfunction()
+
+# compiles 'src' into object file and reports time
+function(compile name src)
+  now_us(start)
+  execute_process(COMMAND "${CXX}" ${flags} ${ARGN} -c "${src}" -o "${src}.o" RESULT_VARIABLE res)
+  now_us(end)
+  if (NOT res EQUAL 0)
+    message(FATAL_ERROR "${src} compilation failed")
+  endif()
+  math(EXPR us "${end} - ${start}")
+  report("${name}" ${us})
+endfunction()
+
+# reports size of object file compiled from 'src'
+function(report_size name src)
+  file(SIZE "${src}.o" bytes)
+  math(EXPR kib "${bytes} / 1024")
+  string(LENGTH "${name}" len)
+  math(EXPR pad "60 - ${len}")
+  string(REPEAT " " ${pad} spaces)
+  string(LENGTH "${kib}" len)
+  math(EXPR pad "12 - ${len}")
+  string(REPEAT " " ${pad} kib_spaces)
+  message("${name}${spaces} ${kib_spaces}${kib} KiB")
+endfunction()
+
+# precompiled header with not generated parts, as CLINOK_PRECOMPILE_HEADERS does
+set(pch "${WORK_DIR}/clinok_pch.hpp")
+file(WRITE "${pch}" "#include <clinok/cli.hpp>\n")
+if (CXX_ID MATCHES "Clang")
+  set(pch_out "${pch}.pch")
+  set(pch_use -include-pch "${pch_out}")
+else()
+  set(pch_out "${pch}.gch")
+  set(pch_use -include "${pch}")
+endif()
+execute_process(COMMAND "${CXX}" ${flags} -x c++-header "${pch}" -o "${pch_out}" RESULT_VARIABLE res)
+if (NOT res EQUAL 0)
+  message(FATAL_ERROR "precompiled header compilation failed")
+endif()
+
+foreach(count ${COUNTS})
+  set(body [[
+int main(int argc, char* argv[]) {
+  cli::error_code ec;
+  return cli::parse(argc, argv, ec).opt_int_0;
+}
+]])
+  set(full "${WORK_DIR}/full_${count}.cpp")
+  file(WRITE "${full}" "#define program_options_file \"options_${count}.def\"\n"
+                       "#include <clinok/cli_interface.hpp>\n" "${body}")
+  set(table "${WORK_DIR}/table_${count}.cpp")
+  file(WRITE "${table}" "#define program_options_file \"options_${count}.def\"\n"
+                        "#include <clinok/cli_interface.hpp>\n"
+                        "template <>\n"
+                        "constexpr inline bool clinok::table_driven_parse<cli::cli_t> = true;\n" "${body}")
+  set(decl "${WORK_DIR}/declarations_${count}.cpp")
+  file(WRITE "${decl}" "#define program_options_file \"options_${count}.def\"\n"
+                       "#include <clinok/cli_declarations.hpp>\n" "${body}")
+
+  compile("compile ${count} options, cli_interface.hpp" "${full}")
+  compile("compile ${count} options, cli_interface.hpp + pch" "${full}" ${pch_use})
+  compile("compile ${count} options, cli_declarations.hpp" "${decl}")
+  compile("compile ${count} options, TABLE_DRIVEN_PARSE" "${table}")
+  report_size("object size ${count} options, generated parse" "${full}")
+  report_size("object size ${count} options, TABLE_DRIVEN_PARSE" "${table}")
+endforeach()
@@ -0,0 +1,66 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "bench.hpp"
+
+#define program_options_file "bench_options.def"
+#define CLINOK_NAMESPACE_NAME bench_cli
+#include <clinok/cli_interface.hpp>
+
+static void write_json_string(std::ostream& out, std::string_view s) {
+  out << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+// format: {"benchmarks": [{"name": "...", "value": 1.5, "unit": "ns"}, ...]}
+static bool write_json(std::string_view path) {
+  std::ofstream out{std::string(path)};
+  if (!out)
+    return false;
+  out << "{\n  \"benchmarks\": [";
+  bool first = true;
+  for (const bench::result& r : bench::results()) {
+    out << (first ? "\n" : ",\n") << "    {\"name\": ";
+    write_json_string(out, r.name);
+    out << ", \"value\": " << r.value << ", \"unit\": ";
+    write_json_string(out, r.unit);
+    out << '}';
+    first = false;
+  }
+  out << "\n  ]\n}\n";
+  return bool(out);
+}
+
+int main(int argc, char* argv[]) {
+  bench_cli::options o = bench_cli::parse_or_exit(argc, argv);
+
+  struct {
+    std::string_view name;
+    void (*run)();
+  } groups[] = {
+      {"option_lookup", &run_option_lookup_benchmarks},
+      {"distance", &run_distance_benchmarks},
+      {"parse_batch", &run_parse_batch_benchmarks},
+      {"response_file", &run_response_file_benchmarks},
+      {"parse", &run_parse_benchmarks},
+      {"tokenize", &run_tokenize_benchmarks},
+      {"live_options", &run_live_options_benchmarks},
+      {"snapshot", &run_snapshot_benchmarks},
+  };
+  for (auto& g : groups) {
+    if (g.name.find(o.filter) != g.name.npos)
+      g.run();
+  }
+  if (!o.json.empty() && !write_json(o.json)) {
+    std::fprintf(stderr, "cannot write results into \"%.*s\"\n", int(o.json.size()), o.json.data());
+    return 1;
+  }
+  return 0;
+}
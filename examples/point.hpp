@@ -33,6 +33,11 @@ struct type_descriptor<Point> {
 
     return it;
   }
+
+  static void format(const Point& p, clinok::args_writer& out) {
+    type_descriptor<int>::format(p.x, out);
+    type_descriptor<int>::format(p.y, out);
+  }
 };
 
 }  // namespace clinok
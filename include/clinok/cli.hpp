@@ -1,9 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+#include <thread>
 #include <vector>
 #include <string_view>
 
 #include "clinok/utils.hpp"
+#include "clinok/perfect_hash.hpp"
+#include "clinok/config_file.hpp"
+#include "clinok/response_file.hpp"
 #include "clinok/type_descriptor.hpp"
 
 namespace clinok {
@@ -79,6 +87,52 @@ constexpr bool has_possible_values_description(O) {
   return !std::is_void_v<decltype(possible_values_description(O{}))>;
 }
 
+// may be specialized for concrete option by COUNT_OCCURRENCES(name) in options file.
+// If true, field 'name' in presented_options counts how many times option presented (up to 255)
+template <typename O>
+constexpr inline bool counts_occurrences = false;
+
+// may be specialized for concrete option by CACHE_DEFAULT_VALUE(name) in options file.
+// If true, default_value(...) is evaluated at most once per process (on first use or by
+// warm_up_default_values) and result is stored in static storage
+template <typename O>
+constexpr inline bool caches_default_value = false;
+
+// bit for each of N options
+template <std::size_t N>
+struct option_bitset {
+  std::array<std::uint64_t, (N + 63) / 64> words{};
+
+  // false if i >= N
+  constexpr bool test(std::size_t i) const noexcept {
+    return i < N && ((words[i / 64] >> (i % 64)) & 1);
+  }
+  constexpr void set(std::size_t i) noexcept {
+    words[i / 64] |= std::uint64_t(1) << (i % 64);
+  }
+  // returns previous value
+  constexpr bool test_and_set(std::size_t i) noexcept {
+    std::uint64_t bit = std::uint64_t(1) << (i % 64);
+    bool was = words[i / 64] & bit;
+    words[i / 64] |= bit;
+    return was;
+  }
+  // true if all bits set in 'mask' are set in *this
+  constexpr bool contains(const option_bitset& mask) const noexcept {
+    std::uint64_t missing = 0;
+    for (std::size_t i = 0; i < words.size(); ++i)
+      missing |= mask.words[i] & ~words[i];
+    return missing == 0;
+  }
+  constexpr std::size_t count() const noexcept {
+    std::size_t c = 0;
+    for (std::uint64_t w : words)
+      c += std::popcount(w);
+    return c;
+  }
+  constexpr bool operator==(const option_bitset&) const = default;
+};
+
 // tag for default_value in OPTION
 template <typename T>
 struct default_value {
@@ -94,13 +148,76 @@ struct is_default_value_tag : std::false_type {};
 template <typename T>
 struct is_default_value_tag<default_value<T>> : std::true_type {};
 
+namespace noexport {
+
+// default(...) strings available at compile time
+template <typename O>
+consteval bool has_static_default() {
+  if constexpr (!O::has_default() || is_tag_option<O>() || !requires { O::default_strings(); })
+    return false;
+  else
+    return !std::is_void_v<decltype(O::default_strings())>;
+}
+
+// default_value(...) is evaluated on each use
+template <typename O>
+consteval bool has_default_provider() {
+  if constexpr (!O::has_default() || is_tag_option<O>())
+    return false;
+  else
+    return is_default_value_tag<std::remove_cvref_t<decltype(O::default_args())>>::value;
+}
+
+template <typename O>
+struct parsed_default {
+  cpp_type_t<O> value{};
+  bool ok = false;
+};
+
+template <typename O>
+constexpr parsed_default<O> parse_default_strings() {
+  constexpr auto strs = O::default_strings();
+  // strings are literals from options file, so null terminated
+  std::array<arg, strs.size()> strs_args;
+  for (std::size_t i = 0; i < strs.size(); ++i)
+    strs_args[i] = strs[i].data();
+  args_t args(strs_args);
+  parsed_default<O> r;
+  errc ec = errc::ok;
+  auto it = parse_option(O{}, args.begin(), args.end(), r.value, ec);
+  r.ok = it == args.end() && ec == errc::ok;
+  return r;
+}
+
+// true if default value parsed at compile time, e.g. for builtin types
+template <typename O>
+concept constexpr_default = has_static_default<O>() && requires {
+  typename std::bool_constant<(parse_default_strings<O>(), true)>;
+};
+
+// thread safe and evaluated once as any function local static.
+// Provider result is stored as is, so e.g. std::string may be default for string_view option
+template <typename O>
+const auto& cached_default_value() {
+  static const auto value = O::default_args().value;
+  return value;
+}
+
+}  // namespace noexport
+
 template <typename O>
 constexpr cpp_type_t<O> default_value_for() {
   if constexpr (is_tag_option<O>()) {
     return false;
-  } else if constexpr (!is_default_value_tag<std::remove_cvref_t<decltype(O::default_args())>>::value) {
-    // error if no default present
+  } else if constexpr (noexport::has_static_default<O>()) {
     // supports array options too (more than 1 arg as default value)
+    if constexpr (noexport::constexpr_default<O>)
+      static_assert(noexport::parse_default_strings<O>().ok, "default value must be parsable");
+    auto r = noexport::parse_default_strings<O>();
+    assert(r.ok);  // default value must be parsable
+    return std::move(r.value);
+  } else if constexpr (!noexport::has_default_provider<O>()) {
+    // error if no default present
     args_t args(O::default_args().begin(), O::default_args().end());
     cpp_type_t<O> value{};
     errc ec = errc::ok;
@@ -108,6 +225,11 @@ constexpr cpp_type_t<O> default_value_for() {
     (void)it;
     assert(it == args.end() && ec == errc::ok);  // default value must be parsable
     return value;
+  } else if constexpr (caches_default_value<O>) {
+    // function local static is not usable at compile time
+    if (std::is_constant_evaluated())
+      return cpp_type_t<O>(O::default_args().value);
+    return cpp_type_t<O>(noexport::cached_default_value<O>());
   } else {
     return cpp_type_t<O>(O::default_args().value);
   }
@@ -136,101 +258,357 @@ constexpr decltype(auto) apply_to_options(auto foo) {
   }(typename CLI::all_options{});
 }
 
+template <CLI_like CLI>
+constexpr std::size_t options_count() {
+  return apply_to_options<CLI>([](auto... os) { return sizeof...(os); });
+}
+
+namespace noexport {
+
+template <CLI_like CLI>
+constexpr inline auto option_names = apply_to_options<CLI>([](auto... os) {
+  return std::array<std::string_view, sizeof...(os)>{name_of<decltype(os)>...};
+});
+
+template <CLI_like CLI>
+constexpr inline auto option_names_table = make_perfect_hash_table(option_names<CLI>);
+
+template <typename O, typename F>
+constexpr void invoke_with_option(F& foo) {
+  foo(O{});
+}
+
+template <typename F, typename>
+struct option_dispatch_table {};
+
+// index in all_options -> function which passes option to F
+template <typename F, typename... Options>
+struct option_dispatch_table<F, typelist<Options...>> {
+  static constexpr void (*value[])(F&) = {&invoke_with_option<Options, F>...};
+};
+
+}  // namespace noexport
+
+// returns index of option in CLI::all_options or options_count<CLI>() if no such option
+template <CLI_like CLI>
+[[nodiscard]] constexpr std::size_t find_option(std::string_view name) noexcept {
+  return noexport::option_names_table<CLI>.find(name);
+}
+
+// passes option with index 'i' in CLI::all_options to 'foo'
+// returns false if no such option
+template <CLI_like CLI>
+constexpr bool visit_option_by_index(std::size_t i, auto foo) {
+  if constexpr (options_count<CLI>() == 0) {
+    return false;
+  } else {
+    if (i >= options_count<CLI>())
+      return false;
+    noexport::option_dispatch_table<decltype(foo), typename CLI::all_options>::value[i](foo);
+    return true;
+  }
+}
+
 // returns false if no such option
 template <CLI_like CLI>
 constexpr bool visit_option(std::string_view name, auto foo) {
-  return apply_to_options<CLI>([&](auto... os) {
-    auto visit_one = [&]<typename O>(O o) -> bool {
-      if (name != name_of<O>) {
-        return false;
-      }
-      foo(o);
-      return true;
-    };
-    return (visit_one(os) || ...);
-  });
+  return visit_option_by_index<CLI>(find_option<CLI>(name), std::move(foo));
 }
 
 template <CLI_like CLI>
 constexpr bool has_option(std::string_view name) {
-  return visit_option<CLI>(name, [](auto) {});
+  return find_option<CLI>(name) != options_count<CLI>();
 }
 
+// true if option 'name' (not alias) presented in arguments when 'p' filled by 'parse'
 template <CLI_like CLI>
-[[nodiscard]] constexpr bool has_alias(std::string_view name) {
-  auto it = std::ranges::find_if(CLI::aliases, [&](auto& x) { return x.first == name; });
+[[nodiscard]] constexpr bool is_presented(const typename CLI::presented_options& p,
+                                          std::string_view name) noexcept {
+  return p.bits.test(find_option<CLI>(name));
+}
+
+namespace noexport {
+
+// bits of options without default values
+template <CLI_like CLI>
+constexpr inline auto required_options_mask = [] {
+  decltype(CLI::presented_options::bits) mask;
+  std::size_t i = 0;
+  for_each_option<CLI>([&]<typename O>(O) {
+    if constexpr (!O::has_default())
+      mask.set(i);
+    ++i;
+  });
+  return mask;
+}();
+
+}  // namespace noexport
+
+namespace noexport {
+
+template <CLI_like CLI>
+constexpr std::size_t unique_aliases_count() {
+  using std::begin;
   using std::end;
-  return it != end(CLI::aliases);
+  std::vector<std::string_view> names;
+  for (auto& [a, _] : CLI::aliases)
+    names.push_back(a);
+  std::ranges::sort(names);
+  return std::unique(names.begin(), names.end()) - names.begin();
 }
 
-// returns resolved option name or empty string if no such alias
+// every alias resolved to option index, so alias to alias chain resolved in one lookup
+template <std::size_t N>
+struct alias_table {
+  perfect_hash_table<N> names;
+  // index of option in all_options or options count if alias is not resolvable
+  std::array<std::uint32_t, N> resolved{};
+};
+
 template <CLI_like CLI>
-[[nodiscard]] constexpr std::string_view resolve_alias(std::string_view alias) {
+constexpr auto make_alias_table() {
+  using std::begin;
   using std::end;
-  auto it = std::ranges::find_if(CLI::aliases, [alias](auto& x) { return x.first == alias; });
-  if (it != end(CLI::aliases)) {
-    if (has_option<CLI>(it->second))
-      return it->second;
-    else {
-      if (has_alias<CLI>(it->second))
-        return resolve_alias<CLI>(it->second);
-      else
-        return "";
+  constexpr std::size_t N = unique_aliases_count<CLI>();
+  std::array<std::string_view, N> names;
+  auto out = names.begin();
+  for (auto& [a, _] : CLI::aliases) {
+    if (std::find(names.begin(), out, a) == out)
+      *out++ = a;
+  }
+  alias_table<N> t{.names = make_perfect_hash_table(names)};
+  const std::size_t aliases_count = std::distance(begin(CLI::aliases), end(CLI::aliases));
+  for (std::size_t i = 0; i < N; ++i) {
+    t.resolved[i] = options_count<CLI>();
+    std::string_view cur = names[i];
+    // first alias with same name is used, chain longer then aliases count is a cycle
+    for (std::size_t step = 0; step < aliases_count; ++step) {
+      auto it = std::ranges::find_if(CLI::aliases, [&](auto& x) { return x.first == cur; });
+      if (it == end(CLI::aliases))
+        break;
+      cur = it->second;
+      if (std::size_t o = find_option<CLI>(cur); o != options_count<CLI>()) {
+        t.resolved[i] = o;
+        break;
+      }
     }
   }
-  return "";
+  return t;
 }
 
-// accepts function which acceps std::string_view to out
-template <CLI_like CLI, typename Out>
-inline Out print_help_message_to(Out out) noexcept {
-  out('\n');
-  auto option_string_len = [&]<typename O>(O o) -> size_t {
-    return sizeof("--") + name_of<O>.size() + placeholder_of<O>.size();
-  };
-  std::size_t largest_help_string =
-      apply_to_options<CLI>([&](auto... opts) { return std::max({size_t(0), option_string_len(opts)...}); });
-  for_each_option<CLI>([&]<typename O>(O o) {
-    out(" --"), out(name_of<O>), out(' '), out(placeholder_of<O>);
-    const int whitespace_count = 2 + largest_help_string - option_string_len(o);
-    for (int i = 0; i < whitespace_count; ++i)
-      out(' ');
-
-    if constexpr (O::has_default() && !is_tag_option<O>()) {
-      out("default: ");
-      if constexpr (!is_default_value_tag<std::remove_cvref_t<decltype(O::default_args())>>::value) {
-        auto args = O::default_args();
-        if (args.size() == 1) {
-          out('"');
-          out(std::string_view(args.front()));
-          out('"');
-        } else {
-          out(noexport::join_comma(O::default_args(), [](arg a) {
-            std::string s;
-            s += '"';
-            s += std::string_view(a);
-            s += '"';
-            return s;
-          }));
+template <CLI_like CLI>
+constexpr inline auto alias_table_for = make_alias_table<CLI>();
+
+}  // namespace noexport
+
+template <CLI_like CLI>
+[[nodiscard]] constexpr bool has_alias(std::string_view name) {
+  return noexport::alias_table_for<CLI>.names.contains(name);
+}
+
+// returns index of option in CLI::all_options to which alias resolved
+// or options_count<CLI>() if no such alias
+template <CLI_like CLI>
+[[nodiscard]] constexpr std::size_t find_alias(std::string_view alias) noexcept {
+  auto& t = noexport::alias_table_for<CLI>;
+  std::size_t i = t.names.find(alias);
+  return i < t.resolved.size() ? t.resolved[i] : options_count<CLI>();
+}
+
+// returns resolved option name or empty string if no such alias
+template <CLI_like CLI>
+[[nodiscard]] constexpr std::string_view resolve_alias(std::string_view alias) {
+  std::size_t i = find_alias<CLI>(alias);
+  return i < options_count<CLI>() ? noexport::option_names<CLI>[i] : "";
+}
+
+namespace noexport {
+
+template <typename O>
+constexpr std::size_t option_help_string_len() {
+  return sizeof("--") + name_of<O>.size() + placeholder_of<O>.size();
+}
+
+template <CLI_like CLI>
+constexpr std::size_t largest_help_string() {
+  return apply_to_options<CLI>(
+      [](auto... opts) { return std::max({size_t(0), option_help_string_len<decltype(opts)>()...}); });
+}
+
+// true if help line for option may be generated at compile time:
+// defaults passed as strings (not default_value(...)) and possible values description is constexpr string
+template <typename O>
+constexpr bool has_static_help() {
+  if constexpr (O::has_default() && !is_tag_option<O>()) {
+    if constexpr (!requires { O::default_strings(); })
+      return false;
+    else if constexpr (std::is_void_v<decltype(O::default_strings())>)
+      return false;
+  }
+  if constexpr (has_possible_values_description(O{})) {
+    using D = decltype(possible_values_description(O{}));
+    return std::is_convertible_v<D, std::string_view> &&
+           !std::is_same_v<std::remove_cvref_t<D>, std::string> && requires {
+             typename std::integral_constant<std::size_t,
+                                             std::string_view(possible_values_description(O{})).size()>;
+           };
+  }
+  return true;
+}
+
+template <CLI_like CLI>
+constexpr bool has_static_help() {
+  return apply_to_options<CLI>([](auto... opts) { return (has_static_help<decltype(opts)>() && ...); });
+}
+
+// may be used at compile time if has_static_help<O>()
+template <CLI_like CLI, typename O>
+constexpr void print_option_help_to(auto& out) {
+  out(" --"), out(name_of<O>), out(' '), out(placeholder_of<O>);
+  const int whitespace_count = 2 + largest_help_string<CLI>() - option_help_string_len<O>();
+  for (int i = 0; i < whitespace_count; ++i)
+    out(' ');
+
+  if constexpr (O::has_default() && !is_tag_option<O>()) {
+    out("default: ");
+    if constexpr (has_static_help<O>()) {
+      constexpr auto strs = O::default_strings();
+      if constexpr (strs.size() == 1) {
+        out('"'), out(strs.front()), out('"');
+      } else {
+        out('[');
+        for (std::size_t i = 0; i < strs.size(); ++i) {
+          if (i != 0)
+            out(", ");
+          out('"'), out(strs[i]), out('"');
         }
+        out(']');
+      }
+    } else if constexpr (!is_default_value_tag<std::remove_cvref_t<decltype(O::default_args())>>::value) {
+      auto args = O::default_args();
+      if (args.size() == 1) {
+        out('"');
+        out(std::string_view(args.front()));
+        out('"');
       } else {
-        // require value to be formattable by `Out`
-        out(O::default_args().value);
+        out(noexport::join_comma(O::default_args(), [](arg a) {
+          std::string s;
+          s += '"';
+          s += std::string_view(a);
+          s += '"';
+          return s;
+        }));
       }
-      out(", ");
-    }
-    out(O::description());
-    if constexpr (has_possible_values_description(O{})) {
-      out(". Possible values: ");
-      out(possible_values_description(O{}));
+    } else if constexpr (caches_default_value<O>) {
+      out(noexport::cached_default_value<O>());
+    } else {
+      // require value to be formattable by `Out`
+      out(O::default_args().value);
     }
-    out('\n');
-  });
+    out(", ");
+  }
+  out(O::description());
+  if constexpr (has_possible_values_description(O{})) {
+    out(". Possible values: ");
+    out(possible_values_description(O{}));
+  }
+  out('\n');
+}
 
+template <CLI_like CLI>
+constexpr void print_aliases_help_to(auto& out) {
   for (auto [a, b] : CLI::aliases) {
     out(" -"), out(a), out(" is an alias to "), out(resolve_alias<CLI>(a)), out('\n');
   }
+}
+
+struct size_counter {
+  std::size_t size = 0;
+
+  constexpr void operator()(char) noexcept {
+    ++size;
+  }
+  constexpr void operator()(std::string_view s) noexcept {
+    size += s.size();
+  }
+};
+
+template <std::size_t N>
+struct static_string {
+  std::array<char, N> data{};
+  std::size_t size = 0;
+
+  constexpr void operator()(char c) noexcept {
+    data[size++] = c;
+  }
+  constexpr void operator()(std::string_view s) noexcept {
+    for (char c : s)
+      data[size++] = c;
+  }
+  constexpr std::string_view str() const noexcept {
+    return std::string_view(data.data(), size);
+  }
+};
+
+// generates string at compile time from 'print' which accepts output function
+template <auto print>
+consteval auto make_static_string() {
+  constexpr std::size_t n = [] {
+    size_counter c;
+    print(c);
+    return c.size;
+  }();
+  static_string<n> s;
+  print(s);
+  return s;
+}
+
+template <CLI_like CLI, typename O>
+constexpr inline auto static_option_help =
+    make_static_string<[](auto& out) { print_option_help_to<CLI, O>(out); }>();
+
+// "[a, b, c]" generated at compile time
+template <const auto& values>
+constexpr inline auto static_values_description = make_static_string<[](auto& out) {
+  out('[');
+  for (std::size_t i = 0; i < std::size(values); ++i) {
+    if (i != 0)
+      out(", ");
+    out(values[i]);
+  }
+  out(']');
+}>();
+
+template <CLI_like CLI>
+constexpr inline auto static_aliases_help =
+    make_static_string<[](auto& out) { print_aliases_help_to<CLI>(out); }>();
 
+// whole help message, exists only if has_static_help<CLI>()
+template <CLI_like CLI>
+constexpr inline auto static_help = make_static_string<[](auto& out) {
+  out('\n');
+  for_each_option<CLI>([&]<typename O>(O) { print_option_help_to<CLI, O>(out); });
+  print_aliases_help_to<CLI>(out);
+}>();
+
+}  // namespace noexport
+
+// accepts function which acceps std::string_view to out
+// help message generated at compile time when possible, then 'out' called once
+template <CLI_like CLI, typename Out>
+CLINOK_COLD inline Out print_help_message_to(Out out) noexcept {
+  if constexpr (noexport::has_static_help<CLI>()) {
+    out(noexport::static_help<CLI>.str());
+  } else {
+    out('\n');
+    for_each_option<CLI>([&]<typename O>(O) {
+      if constexpr (noexport::has_static_help<O>())
+        out(noexport::static_option_help<CLI, O>.str());
+      else
+        noexport::print_option_help_to<CLI, O>(out);
+    });
+    out(noexport::static_aliases_help<CLI>.str());
+  }
   return std::move(out);
 }
 
@@ -274,8 +652,59 @@ constexpr bool validate_aliases() {
   return true;
 }
 
+// may be specialized for concrete CLI
+// unknown option is considered as misspelled option/alias if distance between them less then this value
+template <typename CLI>
+constexpr inline double max_suggestion_distance = 5.0;
+
+// may be specialized for concrete type
+// invalid value is considered as misspelled possible value if distance between them less then this value
+template <typename T>
+constexpr inline double max_value_suggestion_distance = 2.0;
+
+// may be specialized for concrete type
+// if there are more possible values, they are not listed in error message when value suggested
+template <typename T>
+constexpr inline std::size_t max_possible_values_in_error = 16;
+
+namespace noexport {
+
+// built once on first use
+template <typename T>
+const suggestion_index& values_suggestion_index_for() {
+  static const suggestion_index index = [] {
+    std::vector<std::string> candidates;
+    for (std::string_view v : type_descriptor<T>::possible_values())
+      candidates.emplace_back(v);
+    return suggestion_index(std::move(candidates));
+  }();
+  return index;
+}
+
+// built once on first use
+template <CLI_like CLI>
+const suggestion_index& suggestion_index_for() {
+  static const suggestion_index index = [] {
+    std::vector<std::string> candidates;
+    for_each_option<CLI>([&]<typename O>(O) { candidates.push_back(std::string("--").append(name_of<O>)); });
+    for (auto [a, _] : CLI::aliases)
+      candidates.push_back(std::string("-").append(a));
+    return suggestion_index(std::move(candidates));
+  }();
+  return index;
+}
+
+}  // namespace noexport
+
+// fills 'out' with "--option"s and "-alias"es most similar to 'typed', best first.
+// returns count of found suggestions
+template <CLI_like CLI>
+std::size_t suggest(std::string_view typed, std::span<suggestion> out) {
+  return noexport::suggestion_index_for<CLI>().suggest(typed, max_suggestion_distance<CLI>, out);
+}
+
 template <CLI_like CLI, typename Out>
-constexpr Out print_err_to(const error_code& err, Out out) {
+CLINOK_COLD constexpr Out print_err_to(const error_code& err, Out out) {
   if (err.what == errc::ok)
     return std::move(out);
   if (err.what == errc::option_missing) {
@@ -292,7 +721,9 @@ constexpr Out print_err_to(const error_code& err, Out out) {
     return std::move(out);
   }
   out(e2str(err.what));
-  if (err.what != errc::unknown_option && err.what != errc::disallowed_free_arg)  // for better error message
+  // for better error message
+  if (err.what != errc::unknown_option && err.what != errc::disallowed_free_arg &&
+      err.what != errc::invalid_response_file && err.what != errc::invalid_config_file)
     out(" when parsing \"");
   else
     out(" \"");
@@ -305,9 +736,21 @@ constexpr Out print_err_to(const error_code& err, Out out) {
   }
   switch (err.what) {
     case errc::invalid_argument:
-      for_each_option<CLI>([&]<typename O>(O o) {
+      visit_option<CLI>(err.ctx.resolved_name, [&]<typename O>(O o) {
+        using T = logic_type_t<O>;
+        bool list_values = true;
+        if constexpr (requires { type_descriptor<T>::possible_values(); }) {
+          suggestion best;
+          if (noexport::values_suggestion_index_for<T>().suggest(
+                  err.ctx.value, max_value_suggestion_distance<T>, std::span(&best, 1)) != 0) {
+            out(" you probably meant \"");
+            out(best.str);
+            out("\"");
+            list_values = std::size(type_descriptor<T>::possible_values()) <= max_possible_values_in_error<T>;
+          }
+        }
         if constexpr (has_possible_values_description(O{})) {
-          if (name_of<O> == err.ctx.resolved_name) {
+          if (list_values) {
             out(". Possible values are: ");
             out(possible_values_description(o));
           }
@@ -315,19 +758,11 @@ constexpr Out print_err_to(const error_code& err, Out out) {
       });
       break;
     case errc::unknown_option: {
-      std::vector<std::string> optionnames;
-      for_each_option<CLI>(
-          [&]<typename O>(O o) { optionnames.push_back(std::string("--").append(name_of<O>)); });
-
-      for (auto [a, _] : CLI::aliases) {
-        optionnames.push_back(std::string("-").append(a));
-      }
-
-      auto [str, diff] = clinok::best_match_str(err.ctx.typed, optionnames);
-      if (diff < 5) {  // heuristic about misspelling
+      suggestion best;
+      if (suggest<CLI>(err.ctx.typed, std::span(&best, 1)) != 0) {
         out(" you probably meant \"");
-        out(str);
-        if (str.starts_with("--"))
+        out(best.str);
+        if (best.str.starts_with("--"))
           out("\" option");
         else
           out("\" alias");
@@ -342,91 +777,358 @@ constexpr Out print_err_to(const error_code& err, Out out) {
 }
 
 template <typename CLI>
-void print_err(const error_code& err, std::ostream& out = std::cerr) {
+CLINOK_COLD void print_err(const error_code& err, std::ostream& out = std::cerr) {
   print_err_to<CLI>(err, [&](auto&& x) { out << x; });
 }
 
-// assumes first arg as program name
-// increments correspoding field in `presented` for each option, so caller may know which options presented
-// Note: previous value of `presented`  will be forgotten
+namespace noexport {
+
 template <CLI_like CLI>
-constexpr typename CLI::options parse(args_t args, typename CLI::presented_options& presented,
-                                      error_code& ec) noexcept {
-  static_assert(validate_aliases<CLI>());
-  assert(!args.empty());
+consteval bool allows_response_files() {
+  if constexpr (requires { CLI::allow_response_files; })
+    return CLI::allow_response_files;
+  else
+    return false;
+}
 
+// options with all defaults except default_value(...) ones, which are evaluated on each use
+template <CLI_like CLI>
+constexpr typename CLI::options make_default_options() {
   typename CLI::options opts;
-  presented = {};
+  for_each_option<CLI>([&]<typename O>(O o) {
+    if constexpr (O::has_default() && !has_default_provider<O>())
+      o.get(opts) = default_value_for<O>();
+  });
+  // else zero initialized
+  return opts;
+}
 
-  auto set_error = [&](std::string_view typed, errc what, std::string_view resolved) {
-    ec.set_error(what, context{std::string(typed), std::string(resolved)});
+template <typename CLI>
+concept constexpr_default_options = requires {
+  typename std::bool_constant<(make_default_options<CLI>(), true)>;
+};
+
+template <CLI_like CLI>
+constinit inline const typename CLI::options constinit_default_options = make_default_options<CLI>();
+
+// default options are computed once and then copied by each 'parse' call.
+// Image is in static storage if all defaults may be computed at compile time, otherwise built on first use
+template <CLI_like CLI>
+const typename CLI::options& default_options_image() {
+  if constexpr (constexpr_default_options<CLI>) {
+    return constinit_default_options<CLI>;
+  } else {
+    static const typename CLI::options image = make_default_options<CLI>();
+    return image;
+  }
+}
+
+}  // namespace noexport
+
+namespace noexport {
+
+// sets 'v' as if it is value-initialized, std::string and std::vector keep capacity,
+// so parse_into does not allocate for them
+template <typename T>
+constexpr void reset_value(T& v) {
+  if constexpr (requires { v.clear(); v.capacity(); })
+    v.clear();
+  else
+    v = T{};
+}
+
+// argument typed by user resolved into option
+struct resolved_arg {
+  // index in CLI::all_options, options_count<CLI>() for unknown options and free arguments
+  std::size_t option_index = 0;
+  // resolved option name. Typed name without dashes if option unknown, argument itself if free argument
+  std::string_view name = {};
+  errc what = errc::ok;
+  bool free_arg = false;
+};
+
+template <CLI_like CLI>
+constexpr resolved_arg resolve_arg(std::string_view s) noexcept {
+  if (s == "-" || s == "--")
+    return {.option_index = options_count<CLI>(), .what = errc::option_missing};
+  if (s.starts_with("--")) {
+    s.remove_prefix(2);
+    std::size_t i = find_option<CLI>(s);
+    return {i, s, i == options_count<CLI>() ? errc::unknown_option : errc::ok};
+  }
+  if (s.starts_with('-')) {
+    s.remove_prefix(1);
+    std::size_t i = find_alias<CLI>(s);
+    if (i == options_count<CLI>()) [[unlikely]]
+      return {i, s, errc::unknown_option};
+    return {i, option_names<CLI>[i]};
+  }
+  return {options_count<CLI>(), s, CLI::allow_additional_args ? errc::ok : errc::disallowed_free_arg, true};
+}
+
+}  // namespace noexport
+
+namespace noexport {
+
+constexpr void add_free_arg(std::vector<std::string_view>& out, args_t::iterator it) {
+  out.push_back(*it);
+}
+
+constexpr void add_free_arg(free_args_view& out, args_t::iterator it) {
+  out.push(std::to_address(it));
+}
+
+}  // namespace noexport
+
+// may be specialized for concrete CLI or enabled by TABLE_DRIVEN_PARSE in options file.
+// If true, 'parse' is driven by table of type-erased options and one non-template loop instead of code
+// generated for each option, so parse code does not grow with options count.
+// Parsing at compile time still uses generated code
+template <typename CLI>
+constexpr inline bool table_driven_parse = false;
+
+namespace noexport {
+
+// option of table-driven parse
+struct table_option {
+  static constexpr std::size_t npos = std::size_t(-1);
+
+  // of field in options
+  std::size_t offset = 0;
+  // of counter in presented_options, npos if occurrences are not counted
+  std::size_t counter_offset = npos;
+  // sets value-initialized value, one function for each option type
+  void (*reset)(void* field) = nullptr;
+  args_t::iterator (*parse)(void* field, args_t::iterator b, args_t::iterator e, errc& er) = nullptr;
+};
+
+struct parse_table {
+  std::span<const table_option> options;
+  resolved_arg (*resolve)(std::string_view typed) noexcept = nullptr;
+  // nullptr if free arguments are not allowed
+  void (*add_free_arg)(void* opts, args_t::iterator it) = nullptr;
+};
+
+// non-template loop of table-driven parse, same as loop of parse_args_to_defaults.
+// 'presented' is CLI::presented_options, 'presented_bits' its words.
+// 'own_context' is true if 'args' are expanded from response files and destroyed with options
+bool parse_with_table(const parse_table& table, args_t args, void* opts, void* presented,
+                      std::uint64_t* presented_bits, bool own_context, error_code& ec) noexcept;
+
+template <typename T>
+void reset_field(void* field) {
+  reset_value(*static_cast<T*>(field));
+}
+
+// usually only calls type_descriptor<T>::parse_option, so same for all options of same type
+// and merged by compiler
+template <typename O>
+args_t::iterator parse_field(void* field, args_t::iterator b, args_t::iterator e, errc& er) {
+  return parse_option(O{}, b, e, *static_cast<cpp_type_t<O>*>(field), er);
+}
+
+template <CLI_like CLI>
+resolved_arg resolve_arg_erased(std::string_view typed) noexcept {
+  return resolve_arg<CLI>(typed);
+}
+
+template <CLI_like CLI>
+void add_free_arg_erased(void* opts, args_t::iterator it) {
+  add_free_arg(static_cast<typename CLI::options*>(opts)->additional_args, it);
+}
+
+template <CLI_like CLI>
+consteval auto free_arg_fn() noexcept -> void (*)(void*, args_t::iterator) {
+  if constexpr (CLI::allow_additional_args)
+    return &add_free_arg_erased<CLI>;
+  else
+    return nullptr;
+}
+
+// options generated by cli_interface.hpp know offsets of their fields
+template <typename O, typename CLI>
+concept has_field_offset = requires { O::template offset<typename CLI::options>(); };
+
+template <CLI_like CLI, typename O>
+consteval table_option make_table_option() {
+  static_assert(has_field_offset<O, CLI>, "table-driven parse requires O::offset<Options>()");
+  table_option o{
+      .offset = O::template offset<typename CLI::options>(),
+      .reset = &reset_field<cpp_type_t<O>>,
+      .parse = &parse_field<O>,
   };
-  std::string_view s;
-  std::string_view typed;
+  if constexpr (counts_occurrences<O>) {
+    static_assert(std::is_same_v<decltype(O::get(std::declval<typename CLI::presented_options&>())),
+                                 std::uint8_t&>);
+    o.counter_offset = O::template offset<typename CLI::presented_options>();
+  }
+  return o;
+}
+
+template <CLI_like CLI>
+constexpr inline auto table_options = apply_to_options<CLI>([](auto... os) {
+  return std::array<table_option, sizeof...(os)>{make_table_option<CLI, decltype(os)>()...};
+});
+
+template <CLI_like CLI>
+constexpr inline parse_table parse_table_for{
+    .options = table_options<CLI>,
+    .resolve = &resolve_arg_erased<CLI>,
+    .add_free_arg = free_arg_fn<CLI>(),
+};
+
+// parses 'args' without setting default_value(...) defaults and checking required options.
+// returns false on error
+template <CLI_like CLI>
+constexpr bool parse_args_to_defaults(args_t args, typename CLI::options& opts,
+                                      typename CLI::presented_options& presented, error_code& ec) noexcept {
+  static_assert(validate_aliases<CLI>());
+  assert(!args.empty());
+
+  // arguments from response files live only while 'opts' alive
+  bool args_expanded = false;
+  auto set_error = [&](std::string_view typed, errc what, std::string_view resolved,
+                       std::string_view value = {}) {
+    ec.set_error(what, context{typed, resolved, value});
+    if (args_expanded)
+      ec.own();
+  };
+
+  if constexpr (noexport::allows_response_files<CLI>()) {
+    if (std::any_of(args.begin() + 1, args.end(), [](arg a) { return a[0] == '@'; })) {
+      arg failed;
+      if (!expand_response_files(args, opts.response_files, failed)) {
+        set_error(failed, errc::invalid_response_file, "");
+        return false;
+      }
+      args = opts.response_files.args();
+      args_expanded = true;
+    }
+  }
+  if constexpr (table_driven_parse<CLI>) {
+    if (!std::is_constant_evaluated()) {
+      return parse_with_table(parse_table_for<CLI>, args, &opts, &presented, presented.bits.words.data(),
+                              args_expanded, ec);
+    }
+  }
   errc er = errc::ok;
 
   // skip program name
   for (auto it = args.begin() + 1; it != args.end();) {
-    typed = s = *it;
+    std::string_view typed = *it;
     ++it;
-    if (s == "-" || s == "--") {
-      set_error(typed, errc::option_missing, "");
-      return opts;
+    noexport::resolved_arg r = noexport::resolve_arg<CLI>(typed);
+    if (r.what != errc::ok) [[unlikely]] {
+      set_error(typed, r.what, r.name);
+      return false;
     }
-
-    if (s.starts_with("--")) {
-      s.remove_prefix(2);
-    } else if (s.starts_with('-')) {
-      s.remove_prefix(1);
-      std::string_view resolved = resolve_alias<CLI>(s);
-      if (resolved.empty()) [[unlikely]] {
-        set_error(typed, errc::unknown_option, s);
-        return opts;
-      }
-      s = resolved;
-    } else {
-      if constexpr (!CLI::allow_additional_args) {
-        set_error(typed, errc::disallowed_free_arg, s);
-        return opts;
-      } else {
-        // prevent compile time error
-        [&](auto&& o) {
-          if constexpr (CLI::allow_additional_args)
-            o.additional_args.push_back(typed);
-        }(opts);
-        continue;
-      }
+    if (r.free_arg) {
+      if constexpr (CLI::allow_additional_args)
+        noexport::add_free_arg(opts.additional_args, it - 1);
+      continue;
     }
 
-    bool processed = visit_option<CLI>(s, [&](auto o) {
-      ++o.get(presented);
+    const auto values_begin = it;
+    visit_option_by_index<CLI>(r.option_index, [&](auto o) {
+      // option parsed as if there were no default value
+      if (!presented.bits.test_and_set(r.option_index))
+        noexport::reset_value(o.get(opts));
+      if constexpr (counts_occurrences<decltype(o)>) {
+        auto& c = o.get(presented);
+        c += c != std::numeric_limits<std::remove_cvref_t<decltype(c)>>::max();
+      }
       it = parse_option(o, it, args.end(), o.get(opts), er);
     });
 
     if (er != clinok::errc::ok) {
-      set_error(typed, er, s);
-      return opts;
+      set_error(typed, er, r.name, it != values_begin ? std::string_view(*(it - 1)) : std::string_view{});
+      return false;
     }
+  }  // parse loop end
+  return true;
+}
 
-    if (!processed) {
-      set_error(typed, errc::unknown_option, s);
-      return opts;
+// reports last required option which is not presented
+template <CLI_like CLI>
+CLINOK_COLD constexpr void set_required_option_error(const typename CLI::presented_options& presented,
+                                                     error_code& ec) noexcept {
+  const auto& mask = required_options_mask<CLI>;
+  for (std::size_t w = mask.words.size(); w-- != 0;) {
+    if (std::uint64_t missing = mask.words[w] & ~presented.bits.words[w]) {
+      std::string_view name = option_names<CLI>[w * 64 + 63 - std::countl_zero(missing)];
+      ec.set_error(errc::required_option_not_present, context{name, name});
+      return;
     }
-  }  // parse loop end
+  }
+}
 
+// sets default_value(...) defaults of not presented options and checks required options
+template <CLI_like CLI>
+constexpr void finish_parse(typename CLI::options& opts, const typename CLI::presented_options& presented,
+                            error_code& ec) noexcept {
+  // other defaults are already in 'opts'
+  std::size_t i = 0;
   for_each_option<CLI>([&]<typename O>(O o) {
-    // is required and not present in arg list
-    if (o.get(presented) == 0) {
-      if constexpr (!O::has_default()) {
-        set_error(name_of<O>, errc::required_option_not_present, name_of<O>);
-      } else {
+    if constexpr (noexport::has_default_provider<O>()) {
+      if (!presented.bits.test(i))
         o.get(opts) = default_value_for<O>();
-      }
     }
+    ++i;
   });
+  if (!presented.bits.contains(noexport::required_options_mask<CLI>)) [[unlikely]]
+    set_required_option_error<CLI>(presented, ec);
+}
+
+// precondition: 'opts' contains default values (except default_value(...) ones), 'presented' is empty
+template <CLI_like CLI>
+constexpr void parse_to_defaults(args_t args, typename CLI::options& opts,
+                                 typename CLI::presented_options& presented, error_code& ec) noexcept {
+  if (parse_args_to_defaults<CLI>(args, opts, presented, ec))
+    finish_parse<CLI>(opts, presented, ec);
+}
+
+}  // namespace noexport
+
+// assumes first arg as program name
+// sets bit in `presented` for each option (and increments counters of COUNT_OCCURRENCES options),
+// so caller may know which options presented
+// Note: previous value of `presented`  will be forgotten
+// Note: `ec` context points into `args`, use error_code::own if error should outlive them
+template <CLI_like CLI>
+constexpr typename CLI::options parse(args_t args, typename CLI::presented_options& presented,
+                                      error_code& ec) noexcept {
+  typename CLI::options opts = std::is_constant_evaluated() ? noexport::make_default_options<CLI>()
+                                                             : noexport::default_options_image<CLI>();
+  presented = {};
+  noexport::parse_to_defaults<CLI>(args, opts, presented, ec);
   return opts;
 }
 
+// same as 'parse', but reuses 'opts' and 'presented' filled by previous 'parse'/'parse_into' call
+// (or 'opts' from default_options() and empty 'presented').
+// Only options presented on previous call are reset to default values and containers keep capacity,
+// so parsing in loop does not allocate memory (except for response files).
+// 'ec' is cleared before parsing
+template <CLI_like CLI>
+void parse_into(typename CLI::options& opts, typename CLI::presented_options& presented, args_t args,
+                error_code& ec) noexcept {
+  const typename CLI::options& image = noexport::default_options_image<CLI>();
+  const auto& words = presented.bits.words;
+  for (std::size_t w = 0; w < words.size(); ++w) {
+    for (std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+      visit_option_by_index<CLI>(w * 64 + std::countr_zero(bits),
+                                 [&](auto o) { o.get(opts) = o.get(image); });
+    }
+  }
+  presented = {};
+  if constexpr (CLI::allow_additional_args)
+    opts.additional_args.clear();
+  if constexpr (noexport::allows_response_files<CLI>())
+    opts.response_files = {};
+  ec.clear();
+  noexport::parse_to_defaults<CLI>(args, opts, presented, ec);
+}
+
 // assumes first arg as program name
 template <CLI_like CLI>
 constexpr typename CLI::options parse(args_t args, error_code& ec) noexcept {
@@ -434,36 +1136,444 @@ constexpr typename CLI::options parse(args_t args, error_code& ec) noexcept {
   return parse<CLI>(args, presented, ec);
 }
 
-// assumes first arg as program name
+// may be adl-specifizlied for concrete O (ption), reverse of parse_option
+template <typename O>
+void format_option(O, const cpp_type_t<O>& value, args_writer& out) {
+  type_descriptor<logic_type_t<O>>::format(value, out);
+}
+
+namespace noexport {
+
 template <CLI_like CLI>
-inline typename CLI::options parse(int argc, char* argv[], error_code& ec) noexcept {
-  assert(argc >= 0);
-  typename CLI::options o = parse<CLI>(args_range(argc, argv), ec);
-  if (o.help) {
-    print_help_message_to<CLI>([](auto s) { std::cout << s; });
-    std::flush(std::cout);
-    std::exit(0);
-  } else if (ec) {
-    // skip program name
-    bool help_found = false;
-    for (std::string_view a : args_range(argc - 1, argv + 1)) {
-      if (a == "--help") {
-        help_found = true;
-        break;
+void to_args(std::string_view program, const typename CLI::options& opts,
+             const typename CLI::presented_options* presented, args_writer& out) {
+  out.push(program);
+  std::size_t i = 0;
+  for_each_option<CLI>([&]<typename O>(O o) {
+    if (std::size_t index = i++; presented && !presented->bits.test(index))
+      return;
+    // occurrences are counted again by parse of result
+    std::size_t repeats = 1;
+    if constexpr (counts_occurrences<O>) {
+      if (presented)
+        repeats = std::max<std::size_t>(1, o.get(*presented));
+    }
+    for (; repeats != 0; --repeats) {
+      if constexpr (is_tag_option<O>()) {
+        if (o.get(opts))
+          out.push("--", name_of<O>);
+      } else {
+        out.push("--", name_of<O>);
+        format_option(o, o.get(opts), out);
       }
-      if (a.starts_with('-') && !a.starts_with("--"))
-        a.remove_prefix(1);
-      if (has_alias<CLI>(a) && resolve_alias<CLI>(a) == "help") {
-        help_found = true;
-        break;
+    }
+  });
+  if constexpr (CLI::allow_additional_args) {
+    for (std::string_view a : opts.additional_args)
+      out.push(a);
+  }
+}
+
+}  // namespace noexport
+
+// reverse of 'parse': writes 'program', "--name" and value arguments for each option, then free arguments.
+// Tag options are written only if set. Values are written by type_descriptor<T>::format
+// (or adl-found format_option), so parse of result gives same options.
+// Note: free arguments starting with '-' will be parsed as options.
+// returns false if 'out' buffers are too small, see args_writer
+template <CLI_like CLI>
+bool to_args(std::string_view program, const typename CLI::options& opts, args_writer& out) {
+  noexport::to_args<CLI>(program, opts, nullptr, out);
+  return bool(out);
+}
+
+// same as 'to_args', but writes only options presented in 'presented', e.g. child process gets
+// same command line without defaults. COUNT_OCCURRENCES options are repeated as many times as presented
+template <CLI_like CLI>
+bool to_args(std::string_view program, const typename CLI::options& opts,
+             const typename CLI::presented_options& presented, args_writer& out) {
+  noexport::to_args<CLI>(program, opts, &presented, out);
+  return bool(out);
+}
+
+// source from which parse_layered took value of option
+enum struct option_source : std::uint8_t {
+  none,  // default value
+  command_line,
+  environment,
+  config_file,
+};
+
+template <CLI_like CLI>
+struct option_sources {
+  // for each option in CLI::all_options order
+  std::array<option_source, options_count<CLI>()> sources{};
+
+  constexpr option_source of(std::string_view name) const noexcept {
+    std::size_t i = find_option<CLI>(name);
+    return i < sources.size() ? sources[i] : option_source::none;
+  }
+};
+
+// sources of parse_layered, from highest precedence to lowest
+struct layered_sources {
+  // first arg is program name
+  args_t args;
+  // null-terminated array of "NAME=value", e.g. current_environment(). Not used if null.
+  // Variable value is single argument of option
+  const char* const* env = nullptr;
+  // variable for option is 'env_prefix' + option name in upper case with '-' and '.' replaced by '_',
+  // e.g. MYAPP_LOG_LEVEL for option "log-level" and prefix "MYAPP_"
+  std::string_view env_prefix = {};
+  // not used if null
+  const config_file* config = nullptr;
+};
+
+namespace noexport {
+
+constexpr char to_env_char(char c) noexcept {
+  if (c == '-' || c == '.')
+    return '_';
+  return c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c;
+}
+
+// all option names converted by to_env_char, concatenated
+template <CLI_like CLI>
+constexpr inline auto static_env_names = make_static_string<[](auto& out) {
+  for (std::string_view name : option_names<CLI>) {
+    for (char c : name)
+      out(to_env_char(c));
+  }
+}>();
+
+template <CLI_like CLI>
+constexpr inline auto env_names = [] {
+  std::array<std::string_view, options_count<CLI>()> names;
+  std::string_view all = static_env_names<CLI>.str();
+  for (std::size_t i = 0, offset = 0; i < names.size(); offset += names[i].size(), ++i)
+    names[i] = all.substr(offset, option_names<CLI>[i].size());
+  return names;
+}();
+
+template <CLI_like CLI>
+constexpr inline auto env_names_table = make_perfect_hash_table(env_names<CLI>);
+
+// parses option 'i' from environment or config file, all 'values' must be consumed.
+// Tag options accept boolean value, no value means true
+template <CLI_like CLI>
+constexpr errc parse_option_from_source(std::size_t i, args_t values, typename CLI::options& opts,
+                                        typename CLI::presented_options& presented) noexcept {
+  errc er = errc::ok;
+  visit_option_by_index<CLI>(i, [&]<typename O>(O o) {
+    auto& out = o.get(opts);
+    noexport::reset_value(out);
+    args_t::iterator it = values.end();
+    if constexpr (is_tag_option<O>()) {
+      out = true;
+      if (!values.empty())
+        it = type_descriptor<bool>::parse_option(values.begin(), values.end(), out, er);
+    } else {
+      it = parse_option(o, values.begin(), values.end(), out, er);
+    }
+    if (er == errc::ok && it != values.end())
+      er = errc::invalid_argument;
+    if constexpr (counts_occurrences<O>)
+      o.get(presented) = 1;
+  });
+  presented.bits.set(i);
+  return er;
+}
+
+}  // namespace noexport
+
+// parses options from several sources, option found in source with higher precedence hides it in others:
+// command line, then environment, then config file, then default values.
+// Each source is read once in one pass and each option is parsed only from source which wins
+// (in command line and config file last occurrence wins).
+// Options and 'ec' point into 'src.args', environment and 'src.config', so they must outlive result
+template <CLI_like CLI>
+typename CLI::options parse_layered(const layered_sources& src, typename CLI::presented_options& presented,
+                                    option_sources<CLI>& sources, error_code& ec) noexcept {
+  typename CLI::options opts = noexport::default_options_image<CLI>();
+  presented = {};
+  sources = {};
+  if (!noexport::parse_args_to_defaults<CLI>(src.args, opts, presented, ec))
+    return opts;
+  for (std::size_t i = 0; i < sources.sources.size(); ++i) {
+    if (presented.bits.test(i))
+      sources.sources[i] = option_source::command_line;
+  }
+  auto parse_from = [&](option_source source, std::size_t i, std::string_view typed, args_t values) {
+    errc er = noexport::parse_option_from_source<CLI>(i, values, opts, presented);
+    sources.sources[i] = source;
+    if (er != errc::ok) [[unlikely]] {
+      std::string_view value = values.empty() ? std::string_view{} : std::string_view(values.front());
+      ec.set_error(er, context{typed, noexport::option_names<CLI>[i], value});
+    }
+    return er == errc::ok;
+  };
+
+  if (src.env) {
+    const auto hidden = presented.bits;
+    for (const char* const* e = src.env; *e; ++e) {
+      std::string_view var = *e;
+      std::size_t eq = var.find('=');
+      if (eq == var.npos || eq < src.env_prefix.size() || !var.starts_with(src.env_prefix))
+        continue;
+      std::string_view name = var.substr(src.env_prefix.size(), eq - src.env_prefix.size());
+      std::size_t i = noexport::env_names_table<CLI>.find(name);
+      if (i == options_count<CLI>() || hidden.test(i))
+        continue;
+      arg value = *e + eq + 1;
+      if (!parse_from(option_source::environment, i, var.substr(0, eq), args_t(&value, 1)))
+        return opts;
+    }
+  }
+  if (src.config) {
+    const auto hidden = presented.bits;
+    for (const config_file::entry& e : src.config->entries()) {
+      std::size_t i = find_option<CLI>(e.key);
+      if (i == options_count<CLI>()) [[unlikely]] {
+        ec.set_error(errc::unknown_option, context{e.key, e.key});
+        return opts;
       }
+      if (!hidden.test(i) && !parse_from(option_source::config_file, i, e.key, e.values))
+        return opts;
     }
-    if (help_found) {
+  }
+  noexport::finish_parse<CLI>(opts, presented, ec);
+  return opts;
+}
+
+template <CLI_like CLI>
+typename CLI::options parse_layered(const layered_sources& src, error_code& ec) noexcept {
+  typename CLI::presented_options presented;
+  option_sources<CLI> sources;
+  return parse_layered<CLI>(src, presented, sources, ec);
+}
+
+// option or free argument parsed by pull_parser
+struct parse_event {
+  // index of option in CLI::all_options, options_count<CLI>() for free argument
+  std::size_t option_index = 0;
+  // what user typed (including -- or -)
+  std::string_view typed;
+  // resolved option name, empty for free argument
+  std::string_view name;
+  // arguments consumed by option, free argument itself for free argument
+  args_t values;
+  // parsed value of option, valid until next call of pull_parser::next. Use visit_event to access it
+  const void* value = nullptr;
+
+  bool is_free_arg() const noexcept {
+    return value == nullptr;
+  }
+};
+
+// passes option and its parsed value to 'foo'
+// returns false for free argument
+template <CLI_like CLI>
+bool visit_event(const parse_event& e, auto foo) {
+  if (e.is_free_arg())
+    return false;
+  return visit_option_by_index<CLI>(e.option_index, [&]<typename O>(O o) {
+    foo(o, *static_cast<const cpp_type_t<O>*>(e.value));
+  });
+}
+
+namespace noexport {
+
+template <CLI_like CLI>
+constexpr inline std::size_t max_value_size = apply_to_options<CLI>([](auto... os) {
+  return std::max({std::size_t(1), sizeof(cpp_type_t<decltype(os)>)...});
+});
+
+template <CLI_like CLI>
+constexpr inline std::size_t max_value_align = apply_to_options<CLI>([](auto... os) {
+  return std::max({std::size_t(1), alignof(cpp_type_t<decltype(os)>)...});
+});
+
+template <typename T>
+void destroy_value(void* p) noexcept {
+  static_cast<T*>(p)->~T();
+}
+
+}  // namespace noexport
+
+// parses arguments one by one as 'parse' does, but without materializing CLI::options,
+// so memory usage does not depend on arguments count and caller may stop at any moment.
+// Default values are not used and required options are not checked
+template <CLI_like CLI>
+struct pull_parser {
+  // assumes first arg as program name
+  explicit pull_parser(args_t args_) : args(args_) {
+    assert(!args.empty());
+    if constexpr (noexport::allows_response_files<CLI>()) {
+      if (std::any_of(args.begin() + 1, args.end(), [](arg a) { return a[0] == '@'; })) {
+        arg failed;
+        if (!expand_response_files(args, files, failed)) {
+          ec.set_error(errc::invalid_response_file, context{failed, ""});
+          ec.own();
+          return;
+        }
+        args = files.args();
+      }
+    }
+    it = args.begin() + 1;
+  }
+
+  pull_parser(pull_parser&&) = delete;
+  void operator=(pull_parser&&) = delete;
+
+  ~pull_parser() {
+    reset_value();
+  }
+
+  // returns false when there are no more arguments or error happen, see 'error'
+  // Note: 'e' context points into arguments, which are alive while *this is alive
+  bool next(parse_event& e) {
+    reset_value();
+    if (ec || it == args.end())
+      return false;
+    std::string_view typed = *it;
+    ++it;
+    noexport::resolved_arg r = noexport::resolve_arg<CLI>(typed);
+    if (r.what != errc::ok) [[unlikely]] {
+      ec.set_error(r.what, context{typed, r.name});
+      return false;
+    }
+    e.option_index = r.option_index;
+    e.typed = typed;
+    if (r.free_arg) {
+      e.name = {};
+      e.values = args_t(it - 1, it);
+      e.value = nullptr;
+      return true;
+    }
+    e.name = r.name;
+    const auto values_begin = it;
+    errc er = errc::ok;
+    visit_option_by_index<CLI>(r.option_index, [&]<typename O>(O o) {
+      using T = cpp_type_t<O>;
+      T* v = ::new (static_cast<void*>(storage)) T{};
+      value = v;
+      destroy = &noexport::destroy_value<T>;
+      it = parse_option(o, it, args.end(), *v, er);
+    });
+    if (er != errc::ok) {
+      ec.set_error(er, context{typed, r.name, it != values_begin ? std::string_view(*(it - 1)) : ""});
+      return false;
+    }
+    e.values = args_t(values_begin, it);
+    e.value = value;
+    return true;
+  }
+
+  // error which stopped parsing, if any
+  const error_code& error() const noexcept {
+    return ec;
+  }
+
+ private:
+  void reset_value() noexcept {
+    if (destroy)
+      destroy(value);
+    destroy = nullptr;
+  }
+
+  args_t args;
+  args_t::iterator it = args.begin();
+  error_code ec;
+  response_files files;
+  void (*destroy)(void*) = nullptr;
+  void* value = nullptr;
+  // value of current option
+  alignas(noexport::max_value_align<CLI>) unsigned char storage[noexport::max_value_size<CLI>];
+};
+
+// parses each of 'args' as 'parse' does, results stored by same index in 'opts', 'presented' and 'errs'.
+// Command lines are distributed between 'threads_count' threads (including caller) by chunks,
+// so threads which got simple command lines take more work
+// precondition: opts, presented and errs are not smaller then args
+template <CLI_like CLI>
+void parse_batch(std::span<const args_t> args, std::span<typename CLI::options> opts,
+                 std::span<typename CLI::presented_options> presented, std::span<error_code> errs,
+                 unsigned threads_count = std::thread::hardware_concurrency()) {
+  assert(opts.size() >= args.size() && presented.size() >= args.size() && errs.size() >= args.size());
+  if (args.empty())
+    return;
+  constexpr std::size_t chunk_size = 256;
+  std::atomic_size_t next = 0;
+  auto work = [&] {
+    for (;;) {
+      std::size_t b = next.fetch_add(chunk_size, std::memory_order_relaxed);
+      if (b >= args.size())
+        return;
+      std::size_t e = std::min(args.size(), b + chunk_size);
+      for (std::size_t i = b; i < e; ++i) {
+        errs[i].clear();
+        opts[i] = parse<CLI>(args[i], presented[i], errs[i]);
+      }
+    }
+  };
+  std::size_t chunks_count = (args.size() + chunk_size - 1) / chunk_size;
+  std::vector<std::thread> threads(std::min<std::size_t>(std::max(threads_count, 1u), chunks_count) - 1);
+  for (std::thread& t : threads)
+    t = std::thread(work);
+  work();
+  for (std::thread& t : threads)
+    t.join();
+}
+
+template <CLI_like CLI>
+void parse_batch(std::span<const args_t> args, std::span<typename CLI::options> opts,
+                 std::span<error_code> errs, unsigned threads_count = std::thread::hardware_concurrency()) {
+  std::vector<typename CLI::presented_options> presented(args.size());
+  parse_batch<CLI>(args, opts, presented, errs, threads_count);
+}
+
+namespace noexport {
+
+// prints help and terminates program if help option parsed or presented in arguments which failed to parse
+template <CLI_like CLI>
+CLINOK_COLD void exit_if_help_requested(int argc, char* argv[], bool help_parsed) {
+  if (help_parsed) {
+    print_help_message_to<CLI>([](auto s) { std::cout << s; });
+    std::flush(std::cout);
+    std::exit(0);
+  }
+  constexpr std::size_t help_index = find_option<CLI>("help");
+  static_assert(help_index != options_count<CLI>(), "help option is always generated");
+  // skip program name
+  for (std::string_view a : args_range(argc - 1, argv + 1)) {
+    if (a.starts_with('-') && !a.starts_with("--"))
+      a.remove_prefix(1);
+    std::size_t alias_index = find_alias<CLI>(a);
+    if (a == "--help" || (alias_index != options_count<CLI>() && alias_index == help_index)) {
       print_help_message_to<CLI>([](auto s) { std::cout << s; });
       std::flush(std::cout);
       std::exit(EXIT_FAILURE);
     }
   }
+}
+
+template <typename CLI>
+[[noreturn]] CLINOK_COLD void exit_with_error(const error_code& ec) {
+  std::cerr << '\n';
+  print_err<CLI>(ec);
+  std::endl(std::cerr);
+  std::exit(1);
+}
+
+}  // namespace noexport
+
+// assumes first arg as program name
+template <CLI_like CLI>
+inline typename CLI::options parse(int argc, char* argv[], error_code& ec) noexcept {
+  assert(argc >= 0);
+  typename CLI::options o = parse<CLI>(args_range(argc, argv), ec);
+  if (o.help || ec) [[unlikely]]
+    noexport::exit_if_help_requested<CLI>(argc, argv, o.help);
   return o;
 }
 
@@ -473,23 +1583,31 @@ template <typename CLI>
 inline typename CLI::options parse_or_exit(int argc, char* argv[]) {
   error_code ec;
   typename CLI::options o = parse<CLI>(argc, argv, ec);
-  if (ec) {
-    std::cerr << '\n';
-    print_err<CLI>(ec);
-    std::endl(std::cerr);
-    std::exit(1);
-  }
+  if (ec) [[unlikely]]
+    noexport::exit_with_error<CLI>(ec);
   return o;
 }
 
+// evaluates all CACHE_DEFAULT_VALUE(...) defaults concurrently, so several slow providers do not add up.
+// Optional, e.g. at startup, otherwise each provider is evaluated on first use
+template <CLI_like CLI>
+void warm_up_default_values() {
+  std::vector<std::thread> threads;
+  for_each_option<CLI>([&]<typename O>(O) {
+    if constexpr (noexport::has_default_provider<O>() && caches_default_value<O>)
+      threads.emplace_back([] { (void)noexport::cached_default_value<O>(); });
+  });
+  for (std::thread& t : threads)
+    t.join();
+}
+
 template <CLI_like CLI>
 inline typename CLI::options default_options() {
-  typename CLI::options opts;
+  typename CLI::options opts = noexport::default_options_image<CLI>();
   for_each_option<CLI>([&]<typename O>(O o) {
-    if constexpr (O::has_default())
+    if constexpr (noexport::has_default_provider<O>())
       o.get(opts) = default_value_for<O>();
   });
-  // else zero initialized
   return opts;
 }
 
@@ -0,0 +1,47 @@
+// NO pragma once / include guard.
+// thin alternative of cli_interface.hpp: only options struct, enums and declarations of functions,
+// which are defined by cli_interface.hpp included with CLINOK_OUT_OF_LINE_DEFINITIONS in exactly one
+// translation unit. Other translation units do not generate parser, so build faster for big options files
+
+#ifndef CLINOK_NAMESPACE_NAME
+  #define CLINOK_NAMESPACE_NAME cli
+#endif
+
+#ifndef program_options_file
+  #error program_options_file must be defined
+#endif
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include <clinok/response_file.hpp>
+#include <clinok/utils.hpp>
+
+namespace CLINOK_NAMESPACE_NAME {
+
+using namespace ::clinok;
+
+// same enums as in cli_interface.hpp, but without names, e2str is available only with cli_interface.hpp
+#define DECLARE_STRING_ENUM(NAME, ...) enum struct NAME { __VA_ARGS__ };
+#include <clinok/generate.hpp>
+
+#include <clinok/options_struct.hpp>
+
+options parse(args_t args, error_code& ec) noexcept;
+
+// assumes first arg as program name
+options parse(int argc, char* argv[], error_code& ec) noexcept;
+
+// assumes first arg as program name
+// parses args, dumps error and terminates program if error occured
+options parse_or_exit(int argc, char* argv[]);
+
+void print_help_message(std::ostream& out = std::cout);
+
+void print_err(const error_code& err, std::ostream& out = std::cerr);
+
+}  // namespace CLINOK_NAMESPACE_NAME
+
+#undef program_options_file
+#undef CLINOK_NAMESPACE_NAME
@@ -16,6 +16,7 @@
 #include <array>
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <iterator>
 #include <iostream>
@@ -44,6 +45,8 @@ using namespace ::clinok;
                                                                                       \
     static constexpr std::array<std::string_view, values_count> names =               \
         noexport::split_enum<values_count>(#__VA_ARGS__);                             \
+    /* value name -> index in 'names' */                                              \
+    static constexpr auto names_table = noexport::make_perfect_hash_table(names);     \
   };                                                                                  \
                                                                                       \
   constexpr std::string_view e2str(NAME e) {                                          \
@@ -65,6 +68,10 @@ using namespace ::clinok;
   return ::clinok::default_value {   \
     __VA_ARGS__                      \
   }
+// default strings available at compile time, void for default_value(...) and no default
+#define DD_CLI_STATIC_STR
+#define DD_CLI_STATIC_STRdefault(...) return std::to_array<std::string_view>({__VA_ARGS__})
+#define DD_CLI_STATIC_STRdefault_value(...)
 
 #define OPTION(TYPE, NAME, DESCRIPTION, ...)                        \
   struct NAME##_o {                                                 \
@@ -85,6 +92,14 @@ using namespace ::clinok;
     static auto default_args() noexcept {                           \
       DD_CLI_STR##__VA_ARGS__;                                      \
     }                                                               \
+    static consteval auto default_strings() noexcept {              \
+      DD_CLI_STATIC_STR##__VA_ARGS__;                               \
+    }                                                               \
+    /* offset of field 'NAME' in T, used by table-driven parse */   \
+    template <typename T>                                           \
+    static constexpr std::size_t offset() noexcept {                \
+      return offsetof(T, NAME);                                     \
+    }                                                               \
   };
 
 // similar to OPTION, but forbids default(...) and has_default == true
@@ -104,6 +119,10 @@ using namespace ::clinok;
     static constexpr bool has_default() noexcept {    \
       return true;                                    \
     }                                                 \
+    template <typename T>                             \
+    static constexpr std::size_t offset() noexcept {  \
+      return offsetof(T, NAME);                       \
+    }                                                 \
   };
 
 #include <clinok/generate.hpp>
@@ -111,6 +130,9 @@ using namespace ::clinok;
 #undef DD_CLI_STR
 #undef DD_CLI_STRdefault
 #undef DD_CLI_STRdefault_value
+#undef DD_CLI_STATIC_STR
+#undef DD_CLI_STATIC_STRdefault
+#undef DD_CLI_STATIC_STRdefault_value
 }  // namespace CLINOK_NAMESPACE_NAME
 
 namespace clinok {
@@ -126,25 +148,31 @@ namespace clinok {
       return "<string>";                                                                              \
     }                                                                                                 \
                                                                                                       \
-    static std::string possible_values_description() {                                                \
-      return noexport::join_comma(std::span<const ::CLINOK_NAMESPACE_NAME::NAME>(E::values),          \
-                                  [](auto x) { return e2str(x); });                                   \
+    static constexpr std::string_view possible_values_description() {                                 \
+      return noexport::static_values_description<E::names>.str();                                     \
     }                                                                                                 \
                                                                                                       \
-    static args_t::iterator parse_option(args_t::iterator it, args_t::iterator end,                   \
-                                         ::CLINOK_NAMESPACE_NAME::NAME& out, errc& er) {              \
+    static constexpr std::span<const std::string_view> possible_values() {                            \
+      return E::names;                                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    static constexpr args_t::iterator parse_option(args_t::iterator it, args_t::iterator end,         \
+                                                   ::CLINOK_NAMESPACE_NAME::NAME& out, errc& er) {    \
       if (it == end) {                                                                                \
         er = errc::argument_missing;                                                                  \
         return it;                                                                                    \
       }                                                                                               \
-      std::string_view raw_arg = std::string_view(*it);                                               \
-      if (auto it_f = std::find(E::names.begin(), E::names.end(), raw_arg); it_f != E::names.end()) { \
-        std::size_t i = it_f - begin(E::names);                                                       \
+      std::size_t i = E::names_table.find(std::string_view(*it));                                     \
+      if (i < E::names.size()) {                                                                      \
         out = E::values[i];                                                                           \
       } else {                                                                                        \
         er = errc::invalid_argument;                                                                  \
       }                                                                                               \
       return ++it;                                                                                    \
+    }                                                                                                 \
+                                                                                                      \
+    static void format(::CLINOK_NAMESPACE_NAME::NAME value, args_writer& out) {                       \
+      out.push(::CLINOK_NAMESPACE_NAME::e2str(value));                                                \
     }                                                                                                 \
   };
 
@@ -153,14 +181,7 @@ namespace clinok {
 
 namespace CLINOK_NAMESPACE_NAME {
 
-struct options {
-  // zero initialization
-
-#define TAG(name, description) bool name = false;
-#define OPTION(type, name, description, ...) type name = type{};
-#define ALLOW_ADDITIONAL_ARGS std::vector<std::string_view> additional_args;
-#include <clinok/generate.hpp>
-};
+#include <clinok/options_struct.hpp>
 
 struct cli_t {
   using all_options = clinok::noexport::biteoff_first_arg<::clinok::noexport::null_option
@@ -169,11 +190,20 @@ struct cli_t {
                                                           >;
 
   using options = ::CLINOK_NAMESPACE_NAME::options;
-  // contains 'bool' fields for checking if option present during parse
+  // options present during parse
   struct presented_options {
-#define OPTION(type, name, ...) size_t name = 0;
+    // bit for each option in all_options order
+    ::clinok::option_bitset<0
+#define OPTION(...) +1
+#include <clinok/generate.hpp>
+                            >
+        bits;
 
+    // saturating counters of occurrences
+#define COUNT_OCCURRENCES(name) ::std::uint8_t name = 0;
 #include <clinok/generate.hpp>
+
+    constexpr bool operator==(const presented_options&) const = default;
   };
 
   static constexpr auto aliases = noexport::drop_dummy(std::to_array({
@@ -186,6 +216,12 @@ struct cli_t {
 
   static constexpr bool allow_additional_args = 0
 #define ALLOW_ADDITIONAL_ARGS +1
+#define ALLOW_ADDITIONAL_ARGS_VIEW +1
+#include <clinok/generate.hpp>
+      ;
+
+  static constexpr bool allow_response_files = 0
+#define ALLOW_RESPONSE_FILES +1
 #include <clinok/generate.hpp>
       ;
 };
@@ -206,6 +242,16 @@ inline options parse(int argc, char* argv[], error_code& ec) noexcept {
   return clinok::parse<CLI>(argc, argv, ec);
 }
 
+template <CLI_like CLI = cli_t>
+inline options parse_layered(const layered_sources& src, error_code& ec) noexcept {
+  return clinok::parse_layered<CLI>(src, ec);
+}
+
+template <CLI_like CLI = cli_t>
+inline bool to_args(std::string_view program, const options& o, args_writer& out) {
+  return clinok::to_args<CLI>(program, o, out);
+}
+
 template <typename Out, CLI_like CLI = cli_t>
 constexpr Out print_err_to(const error_code& err, Out out) {
   return clinok::print_err_to<CLI>(err, out);
@@ -237,9 +283,52 @@ namespace clinok {
   template <>                      \
   constexpr inline std::string_view placeholder_of<::CLINOK_NAMESPACE_NAME::NAME##_o> = __VA_ARGS__;
 
+#define COUNT_OCCURRENCES(NAME) \
+  template <>                   \
+  constexpr inline bool counts_occurrences<::CLINOK_NAMESPACE_NAME::NAME##_o> = true;
+
+#define CACHE_DEFAULT_VALUE(NAME) \
+  template <>                     \
+  constexpr inline bool caches_default_value<::CLINOK_NAMESPACE_NAME::NAME##_o> = true;
+
+#define TABLE_DRIVEN_PARSE \
+  template <>              \
+  constexpr inline bool table_driven_parse<::CLINOK_NAMESPACE_NAME::cli_t> = true;
+
 #include <clinok/generate.hpp>
 
 }  // namespace clinok
 
+#ifdef CLINOK_OUT_OF_LINE_DEFINITIONS
+
+// definitions of functions declared by cli_declarations.hpp, so other translation units
+// do not generate parser and include only declarations
+namespace CLINOK_NAMESPACE_NAME {
+
+options parse(args_t args, error_code& ec) noexcept {
+  return clinok::parse<cli_t>(args, ec);
+}
+
+options parse(int argc, char* argv[], error_code& ec) noexcept {
+  return clinok::parse<cli_t>(argc, argv, ec);
+}
+
+options parse_or_exit(int argc, char* argv[]) {
+  return clinok::parse_or_exit<cli_t>(argc, argv);
+}
+
+void print_help_message(std::ostream& out) {
+  clinok::print_help_message_to<cli_t>([&](auto s) { out << s; });
+}
+
+void print_err(const error_code& err, std::ostream& out) {
+  clinok::print_err<cli_t>(err, out);
+}
+
+}  // namespace CLINOK_NAMESPACE_NAME
+
+  #undef CLINOK_OUT_OF_LINE_DEFINITIONS
+#endif
+
 #undef program_options_file
 #undef CLINOK_NAMESPACE_NAME
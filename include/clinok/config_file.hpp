@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "clinok/utils.hpp"
+
+namespace clinok {
+
+// private (copy on write) mapping of whole file into memory.
+// Pages not written yet reflect later changes of file. Truncation of file drops even written pages
+// and access to them raises SIGBUS, so mapped file must not be truncated or rewritten while mapped.
+// Use 'config_file::read' for files which may change
+struct mapped_file {
+  mapped_file() = default;
+  mapped_file(mapped_file&&) noexcept;
+  mapped_file& operator=(mapped_file&&) noexcept;
+  ~mapped_file();
+
+  // returns false if file cannot be opened or mapped
+  [[nodiscard]] bool open(const char* path) noexcept;
+  void close() noexcept;
+
+  char* data() const noexcept {
+    return ptr;
+  }
+  std::size_t size() const noexcept {
+    return len;
+  }
+
+ private:
+  char* ptr = nullptr;
+  std::size_t len = 0;
+};
+
+// 'key = value' file, INI-like:
+// empty lines and lines starting with '#' or ';' are ignored, '[name]' starts section 'name'.
+// Value is split into arguments as by split_command_line, so value with spaces may be quoted
+// and option with several arguments gets them separated by spaces, e.g. 'location = 1 2'.
+// File is mapped into memory, keys and values are not copied and point into mapping
+struct config_file {
+  struct entry {
+    std::string_view key;
+    args_t values;
+    std::size_t line = 0;
+  };
+
+  // reads entries before first section and entries of section 'section', other sections are skipped.
+  // returns false if file cannot be read or has invalid line, see failed_line.
+  // Note: unchanged pages of mapping reflect later changes of file, use 'read' for files which may change
+  [[nodiscard]] bool open(const char* path, std::string_view section = {});
+  // same as 'open', but copies file into memory instead of mapping it
+  [[nodiscard]] bool read(const char* path, std::string_view section = {});
+
+  std::span<const entry> entries() const noexcept {
+    return entries_;
+  }
+  // line without '=' or with unterminated quote, 0 if file cannot be read
+  std::size_t failed_line() const noexcept {
+    return failed;
+  }
+
+ private:
+  void reset() noexcept;
+  bool parse(char* b, char* e, std::string_view section, bool end_writable);
+
+  mapped_file file;
+  // file content if it is read instead of mapped
+  std::unique_ptr<char[]> buffer;
+  // last line of file, if it cannot be null-terminated inside mapping
+  std::unique_ptr<char[]> tail;
+  std::vector<arg> args;
+  std::vector<entry> entries_;
+  std::size_t failed = 0;
+};
+
+// null-terminated array of "NAME=value" strings of current process ('environ')
+const char* const* current_environment() noexcept;
+
+}  // namespace clinok
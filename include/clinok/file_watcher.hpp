@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace clinok {
+
+// calls 'on_change' from background thread after file 'path' is modified, created or replaced
+// (e.g. by rename, as editors and config management tools do).
+// Uses inotify on linux, on other platforms checks modification time every 'poll_interval'
+struct file_watcher {
+  file_watcher(std::string path, std::function<void()> on_change,
+               std::chrono::milliseconds poll_interval = std::chrono::milliseconds(100));
+  file_watcher(file_watcher&&) = delete;
+  void operator=(file_watcher&&) = delete;
+  // waits for running 'on_change' call
+  ~file_watcher();
+
+  const std::string& path() const noexcept {
+    return file_path;
+  }
+
+ private:
+  void run_inotify();
+  void run_polling();
+
+  std::string file_path;
+  std::function<void()> on_change;
+  std::chrono::milliseconds poll_interval;
+  std::atomic_bool stop_requested = false;
+  // fd which wakes watching thread on stop, -1 when polling
+  int wake_fd = -1;
+  std::thread thread;
+};
+
+}  // namespace clinok
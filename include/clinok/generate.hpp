@@ -39,10 +39,30 @@
   #define ALLOW_ADDITIONAL_ARGS
 #endif
 
+#ifndef ALLOW_ADDITIONAL_ARGS_VIEW
+  #define ALLOW_ADDITIONAL_ARGS_VIEW
+#endif
+
+#ifndef ALLOW_RESPONSE_FILES
+  #define ALLOW_RESPONSE_FILES
+#endif
+
 #ifndef RENAME
   #define RENAME(OLDNAME, NEWNAME)
 #endif
 
+#ifndef COUNT_OCCURRENCES
+  #define COUNT_OCCURRENCES(NAME)
+#endif
+
+#ifndef CACHE_DEFAULT_VALUE
+  #define CACHE_DEFAULT_VALUE(NAME)
+#endif
+
+#ifndef TABLE_DRIVEN_PARSE
+  #define TABLE_DRIVEN_PARSE
+#endif
+
 #include program_options_file
 TAG(help, "list of all options")
 
@@ -53,7 +73,12 @@ TAG(help, "list of all options")
 #undef INTEGER
 #undef ALIAS
 #undef ALLOW_ADDITIONAL_ARGS
+#undef ALLOW_ADDITIONAL_ARGS_VIEW
+#undef ALLOW_RESPONSE_FILES
 #undef DECLARE_STRING_ENUM
 #undef RENAME
+#undef COUNT_OCCURRENCES
+#undef CACHE_DEFAULT_VALUE
+#undef TABLE_DRIVEN_PARSE
 #undef SET_LOGIC_TYPE
 #undef SET_PLACEHOLDER
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clinok/cli.hpp"
+#include "clinok/file_watcher.hpp"
+
+namespace clinok {
+
+namespace noexport {
+
+// read-copy-update with two reader counters per slot (as in SRCU).
+// Readers are wait-free and touch only cache line of own thread slot,
+// writer waits until readers which may see previous value leave
+struct rcu_domain {
+  static constexpr std::size_t slots_count = 64;
+
+  struct alignas(64) slot {
+    std::atomic<std::int64_t> readers[2] = {0, 0};
+  };
+
+  // returns counter which must be passed to 'unlock'.
+  // Epoch load, increment and load of protected value by reader and publishing, epoch flip and counter
+  // loads by writer are all seq_cst, so reader either is seen by writer or sees new value
+  std::atomic<std::int64_t>& lock() noexcept {
+    auto& c = slots[this_thread_slot()].readers[epoch.load(std::memory_order_seq_cst) & 1];
+    c.fetch_add(1, std::memory_order_seq_cst);
+    return c;
+  }
+
+  static void unlock(std::atomic<std::int64_t>& c) noexcept {
+    c.fetch_sub(1, std::memory_order_release);
+  }
+
+  // must be called after publishing new value, writers must be serialized.
+  // New readers go to other counter after flip, so waiting for old one always ends.
+  // Second flip is for readers which loaded epoch before first flip, but incremented counter after it
+  void synchronize() noexcept {
+    for (int i = 0; i < 2; ++i) {
+      unsigned old = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+      for (slot& s : slots) {
+        while (s.readers[old].load(std::memory_order_seq_cst) != 0)
+          std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  static std::size_t this_thread_slot() noexcept {
+    static std::atomic_size_t next = 0;
+    thread_local std::size_t i = next.fetch_add(1, std::memory_order_relaxed) % slots_count;
+    return i;
+  }
+
+  std::atomic_uint epoch = 0;
+  slot slots[slots_count];
+};
+
+}  // namespace noexport
+
+// options which may be reloaded while program runs, e.g. by daemon when its config changes.
+// Readers get current snapshot without locks, reload parses new snapshot and publishes it atomically,
+// previous snapshot destroyed after all its readers leave. If parse fails, current snapshot stays.
+// Until first successful reload snapshot contains default options.
+// Reader counters are kept in 64 slots, threads are assigned to them round-robin, so with more threads
+// several threads share slot (and its cache line). Reload waits for all readers started before it,
+// so reload (or watcher reload) deadlocks if called by thread which keeps 'reader' alive
+template <CLI_like CLI>
+struct live_options {
+  struct snapshot {
+    // string options may point into it
+    config_file config;
+    typename CLI::options options = default_options<CLI>();
+    typename CLI::presented_options presented;
+    option_sources<CLI> sources;
+  };
+
+  // keeps snapshot alive, should be short living (reload waits for it) and must not outlive live_options.
+  // Must not be kept while calling reload on same thread
+  struct reader {
+    reader(std::atomic<std::int64_t>& c, const snapshot* s) noexcept : counter(c), s(s) {
+    }
+    reader(reader&&) = delete;
+    void operator=(reader&&) = delete;
+    ~reader() {
+      noexport::rcu_domain::unlock(counter);
+    }
+
+    const snapshot& operator*() const noexcept {
+      return *s;
+    }
+    const snapshot* operator->() const noexcept {
+      return s;
+    }
+
+   private:
+    std::atomic<std::int64_t>& counter;
+    const snapshot* s;
+  };
+
+  // on each reload 'config_path' (if not empty) is read and parsed with 'src', 'src.config' is ignored.
+  // 'src.args' and 'src.env' must outlive live_options
+  explicit live_options(layered_sources src, std::string config_path = {}, std::string section = {})
+      : src(src), config_path(std::move(config_path)), section(std::move(section)) {
+    this->src.config = nullptr;
+  }
+  live_options(live_options&&) = delete;
+  void operator=(live_options&&) = delete;
+  ~live_options() {
+    // watchers may reload
+    watchers.clear();
+    delete current.load();
+  }
+
+  // wait-free
+  reader read() const noexcept {
+    auto& c = rcu.lock();
+    return reader(c, current.load(std::memory_order_seq_cst));
+  }
+
+  // thread safe, concurrent reloads are serialized
+  bool reload(error_code& ec) {
+    ec.clear();
+    auto s = std::make_unique<snapshot>();
+    // file is copied, because mapping would change with file
+    if (!config_path.empty() && !s->config.read(config_path.c_str(), section)) {
+      ec.set_error(errc::invalid_config_file, context{config_path, ""});
+    } else {
+      layered_sources layered = src;
+      if (!config_path.empty())
+        layered.config = &s->config;
+      s->options = parse_layered<CLI>(layered, s->presented, s->sources, ec);
+    }
+    // context may point into config of failed snapshot
+    if (ec)
+      ec.own();
+    std::lock_guard lock(writer_mtx);
+    last_err = ec;
+    if (ec)
+      return false;
+    const snapshot* old = current.exchange(s.release(), std::memory_order_seq_cst);
+    rcu.synchronize();
+    delete old;
+    reloads.fetch_add(1, std::memory_order_release);
+    return true;
+  }
+
+  // reloads on each change of 'path' (config file, response file from args or any other file).
+  // Not thread safe
+  void watch(std::string path) {
+    watchers.push_back(std::make_unique<file_watcher>(std::move(path), [this] {
+      error_code ec;
+      (void)reload(ec);
+    }));
+  }
+
+  // error of last reload, e.g. started by watcher
+  error_code last_error() const {
+    std::lock_guard lock(writer_mtx);
+    return last_err;
+  }
+
+  // count of successful reloads
+  std::size_t reloads_count() const noexcept {
+    return reloads.load(std::memory_order_acquire);
+  }
+
+ private:
+  layered_sources src;
+  std::string config_path;
+  std::string section;
+  std::atomic<const snapshot*> current = new snapshot;
+  mutable noexport::rcu_domain rcu;
+  mutable std::mutex writer_mtx;
+  error_code last_err;
+  std::atomic_size_t reloads = 0;
+  // destroyed first, they may reload
+  std::vector<std::unique_ptr<file_watcher>> watchers;
+};
+
+}  // namespace clinok
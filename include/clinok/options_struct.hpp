@@ -0,0 +1,15 @@
+// NO pragma once / include guard.
+// generates options struct for program_options_file in current namespace,
+// shared by cli_interface.hpp and cli_declarations.hpp, so both define same struct
+
+struct options {
+  // zero initialization
+
+#define TAG(name, description) bool name = false;
+#define OPTION(type, name, description, ...) type name = type{};
+#define ALLOW_ADDITIONAL_ARGS std::vector<std::string_view> additional_args;
+#define ALLOW_ADDITIONAL_ARGS_VIEW ::clinok::free_args_view additional_args;
+// keeps mapped response files, so options parsed from them stay valid
+#define ALLOW_RESPONSE_FILES ::clinok::response_files response_files;
+#include <clinok/generate.hpp>
+};
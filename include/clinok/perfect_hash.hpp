@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+namespace clinok::noexport {
+
+// FNV-1a, used for all compile-time name tables
+constexpr std::uint64_t hash_str(std::string_view s) noexcept {
+  std::uint64_t h = 0xcbf29ce484222325;
+  for (char c : s) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 0x100000001b3;
+  }
+  return h;
+}
+
+// mixes string hash with bucket displacement, so string hashed only once per lookup
+constexpr std::uint64_t mix_hash(std::uint64_t h, std::uint64_t d) noexcept {
+  h += d * 0x9e3779b97f4a7c15;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  return h;
+}
+
+// hash and displace perfect hash for set of strings, known at compile time.
+// Lookup costs one hash of key and at most one string compare
+template <std::size_t N>
+struct perfect_hash_table {
+  static constexpr std::size_t buckets_count = std::bit_ceil(N / 2 + 1);
+  static constexpr std::size_t slots_count = std::bit_ceil(2 * N + 1);
+
+  std::array<std::string_view, N> keys{};
+  std::array<std::uint32_t, buckets_count> displacements{};
+  // index in 'keys' or N if slot is empty
+  std::array<std::uint32_t, slots_count> slots{};
+
+  static constexpr std::size_t bucket_for(std::uint64_t h) noexcept {
+    return h & (buckets_count - 1);
+  }
+
+  static constexpr std::size_t slot_for(std::uint64_t h, std::uint32_t d) noexcept {
+    return mix_hash(h, d) & (slots_count - 1);
+  }
+
+  // returns index of 'key' in 'keys' or N if not found
+  constexpr std::size_t find(std::string_view key) const noexcept {
+    if constexpr (N == 0) {
+      return 0;
+    } else {
+      std::uint64_t h = hash_str(key);
+      std::uint32_t i = slots[slot_for(h, displacements[bucket_for(h)])];
+      return i < N && keys[i] == key ? i : N;
+    }
+  }
+
+  constexpr bool contains(std::string_view key) const noexcept {
+    return find(key) != N;
+  }
+};
+
+template <std::size_t N>
+constexpr perfect_hash_table<N> make_perfect_hash_table(const std::array<std::string_view, N>& keys) {
+  using table_t = perfect_hash_table<N>;
+  table_t t;
+  t.keys = keys;
+  t.slots.fill(N);
+  if constexpr (N == 0) {
+    return t;
+  } else {
+    std::array<std::uint64_t, N> hashes;
+    for (std::size_t i = 0; i < N; ++i)
+      hashes[i] = hash_str(keys[i]);
+    // counting sort of keys by bucket, no comparison sorts because of constexpr evaluation limits.
+    // keys of bucket 'b' are by_bucket[bucket_begin[b], bucket_begin[b + 1])
+    std::array<std::uint32_t, table_t::buckets_count + 1> bucket_begin{};
+    for (std::uint64_t h : hashes)
+      ++bucket_begin[table_t::bucket_for(h) + 1];
+    std::size_t max_bucket_size = 0;
+    for (std::size_t b = 0; b < table_t::buckets_count; ++b) {
+      max_bucket_size = std::max<std::size_t>(max_bucket_size, bucket_begin[b + 1]);
+      bucket_begin[b + 1] += bucket_begin[b];
+    }
+    std::array<std::uint32_t, N> by_bucket;
+    std::array<std::uint32_t, table_t::buckets_count> cursor;
+    std::copy_n(bucket_begin.begin(), table_t::buckets_count, cursor.begin());
+    for (std::uint32_t i = 0; i < N; ++i)
+      by_bucket[cursor[table_t::bucket_for(hashes[i])]++] = i;
+
+    // equal keys have equal hashes, so they are in same bucket
+    for (std::size_t bucket = 0; bucket < table_t::buckets_count; ++bucket) {
+      for (std::size_t i = bucket_begin[bucket]; i < bucket_begin[bucket + 1]; ++i) {
+        for (std::size_t j = i + 1; j < bucket_begin[bucket + 1]; ++j) {
+          if (keys[by_bucket[i]] == keys[by_bucket[j]])
+            throw +"duplicate names";
+        }
+      }
+    }
+    // biggest buckets placed first
+    for (std::size_t size = max_bucket_size; size > 0; --size) {
+      for (std::size_t bucket = 0; bucket < table_t::buckets_count; ++bucket) {
+        if (bucket_begin[bucket + 1] - bucket_begin[bucket] != size)
+          continue;
+        auto b = by_bucket.begin() + bucket_begin[bucket];
+        auto e = b + size;
+        for (std::uint32_t d = 0;; ++d) {
+          if (d == (1 << 20))
+            throw +"cannot build perfect hash";
+          auto placed = b;
+          for (; placed != e; ++placed) {
+            std::size_t s = table_t::slot_for(hashes[*placed], d);
+            if (t.slots[s] != N)
+              break;
+            t.slots[s] = *placed;
+          }
+          if (placed == e) {
+            t.displacements[bucket] = d;
+            break;
+          }
+          // rollback
+          for (auto it = b; it != placed; ++it)
+            t.slots[table_t::slot_for(hashes[*it], d)] = N;
+        }
+      }
+    }
+    return t;
+  }
+}
+
+}  // namespace clinok::noexport
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "clinok/config_file.hpp"
+#include "clinok/utils.hpp"
+
+namespace clinok {
+
+namespace noexport {
+
+struct response_files_storage {
+  std::vector<arg> args;
+  std::vector<mapped_file> files;
+  // last argument of file, which cannot be null-terminated inside mapping
+  std::vector<std::unique_ptr<char[]>> tails;
+};
+
+}  // namespace noexport
+
+// arguments expanded from response files. Arguments are not copied, they point into private file mappings,
+// so options parsed from them valid while any copy of this object exists
+struct response_files {
+  std::shared_ptr<const noexport::response_files_storage> storage;
+
+  args_t args() const noexcept {
+    return storage ? args_t(storage->args) : args_t{};
+  }
+};
+
+// response file is split into arguments by split_command_line rules, e.g. arguments may be quoted.
+// '@' in response file is not expanded, there are no nested response files
+
+// assumes first arg as program name
+// replaces each "@path" argument with arguments from file 'path'. File is mapped (see mapped_file),
+// so it must not be changed while 'out' or options parsed from it are alive, e.g. truncating it
+// makes access to arguments raise SIGBUS. Use response_file_reader for files which may change
+// returns false on error, 'failed' is set to argument with file which cannot be read
+// or has unterminated quote
+[[nodiscard]] bool expand_response_files(args_t args, response_files& out, arg& failed);
+
+// reads response file by chunks with same rules as expand_response_files,
+// so memory usage does not depend on file size (only on longest argument)
+struct response_file_reader {
+  explicit response_file_reader(const char* path, std::size_t chunk_size = 64 * 1024);
+  response_file_reader(response_file_reader&&) = delete;
+  void operator=(response_file_reader&&) = delete;
+  ~response_file_reader();
+
+  bool is_open() const noexcept {
+    return file != nullptr;
+  }
+
+  // returns false when there are no more arguments or on error, see 'failed'.
+  // 'out' is valid until next call
+  bool next(std::string_view& out);
+
+  // read error or unterminated quote
+  bool failed() const noexcept {
+    return failed_;
+  }
+
+ private:
+  std::FILE* file = nullptr;
+  std::vector<char> buf;
+  std::size_t b = 0;
+  std::size_t e = 0;
+  bool eof = false;
+  bool failed_ = false;
+};
+
+}  // namespace clinok
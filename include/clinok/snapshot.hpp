@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "clinok/cli.hpp"
+#include "clinok/perfect_hash.hpp"
+
+namespace clinok {
+
+// binary snapshot of parsed options, e.g. parsed once by parent process and restored by many workers
+// with same command line, environment and config.
+// Layout: header, presented options (bitset words, then occurrence counters in CLI::all_options order),
+// then each option in CLI::all_options order
+// (trivially copyable values as is, strings as 64-bit size and chars), then free arguments.
+// Free arguments of ALLOW_ADDITIONAL_ARGS_VIEW point into parsed arguments, such CLIs are rejected.
+// Values are stored in native byte order, snapshot is for processes of same binary on same machine
+
+constexpr inline std::uint32_t snapshot_format_version = 2;
+
+enum struct snapshot_errc {
+  ok,
+  too_small,         // buffer passed to save_snapshot has not enough space, see snapshot_size
+  not_a_snapshot,    // no snapshot header or snapshot is truncated
+  version_mismatch,  // snapshot written by other version of clinok
+  schema_mismatch,   // snapshot written for other options (names, types or order)
+};
+
+// specialize for trivially copyable option types which are valid for any bytes and hold no pointers,
+// e.g. struct of integers. Arithmetic types, strings and enums generated by DECLARE_STRING_ENUM
+// are supported without it, bool and enum values are validated on restore
+template <typename T>
+constexpr inline bool snapshot_restorable = false;
+
+namespace noexport {
+
+struct snapshot_header {
+  char magic[4] = {'C', 'L', 'N', 'K'};
+  std::uint32_t version = snapshot_format_version;
+  std::uint64_t schema = 0;
+  // whole snapshot size
+  std::uint64_t size = 0;
+};
+
+template <typename T>
+consteval std::string_view type_name() {
+  // contains T, exact format depends on compiler, so hash is same only for same compiler
+#if defined(_MSC_VER) && !defined(__clang__)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+
+template <typename T>
+concept snapshot_string = std::same_as<T, std::string_view> || std::same_as<T, std::string>;
+
+// enum with values 0 .. possible_values().size() - 1
+template <typename T>
+concept snapshot_enum = std::is_enum_v<T> && requires { type_descriptor<T>::possible_values().size(); };
+
+template <typename T>
+concept snapshot_value = snapshot_string<T> || std::is_arithmetic_v<T> || snapshot_enum<T> ||
+                         (snapshot_restorable<T> && std::is_trivially_copyable_v<T>);
+
+template <typename CLI>
+concept snapshot_free_args = requires(typename CLI::options& o) {
+  { o.additional_args } -> std::same_as<std::vector<std::string_view>&>;
+};
+
+// free_args_view points into parsed arguments and cannot be restored
+template <typename CLI>
+concept snapshot_free_args_view = requires(typename CLI::options& o) {
+  { o.additional_args } -> std::same_as<free_args_view&>;
+};
+
+constexpr std::uint64_t hash_combine(std::uint64_t h, std::uint64_t x) noexcept {
+  return mix_hash(h ^ x, 1);
+}
+
+template <CLI_like CLI>
+constexpr std::uint64_t make_schema_hash() {
+  std::uint64_t h = hash_combine(hash_str("clinok snapshot"), snapshot_format_version);
+  for_each_option<CLI>([&]<typename O>(O) {
+    h = hash_combine(h, hash_str(name_of<O>));
+    h = hash_combine(h, hash_str(type_name<cpp_type_t<O>>()));
+    h = hash_combine(h, sizeof(cpp_type_t<O>));
+    h = hash_combine(h, counts_occurrences<O>);
+  });
+  return hash_combine(h, snapshot_free_args<CLI>);
+}
+
+struct snapshot_writer {
+  char* pos;
+
+  void write(const void* p, std::size_t n) noexcept {
+    std::memcpy(pos, p, n);
+    pos += n;
+  }
+  void write_str(std::string_view s) noexcept {
+    std::uint64_t size = s.size();
+    write(&size, sizeof(size));
+    write(s.data(), s.size());
+  }
+};
+
+struct snapshot_reader {
+  const char* pos;
+  const char* end;
+
+  bool read(void* p, std::size_t n) noexcept {
+    if (std::size_t(end - pos) < n)
+      return false;
+    std::memcpy(p, pos, n);
+    pos += n;
+    return true;
+  }
+  // bool and enum bytes are checked, other types are valid for any bytes
+  template <typename T>
+  bool read_value(T& out) noexcept {
+    if constexpr (std::same_as<T, bool>) {
+      unsigned char b;
+      if (!read(&b, 1) || b > 1)
+        return false;
+      out = b;
+    } else if constexpr (snapshot_enum<T>) {
+      using U = std::underlying_type_t<T>;
+      U v;
+      if (!read(&v, sizeof(v)) || std::make_unsigned_t<U>(v) >= type_descriptor<T>::possible_values().size())
+        return false;
+      out = T(v);
+    } else {
+      return read(&out, sizeof(T));
+    }
+    return true;
+  }
+  // result points into snapshot
+  bool read_str(std::string_view& s) noexcept {
+    std::uint64_t size;
+    if (!read(&size, sizeof(size)) || std::uint64_t(end - pos) < size)
+      return false;
+    s = std::string_view(pos, size);
+    pos += size;
+    return true;
+  }
+};
+
+// presented options are written field by field, so padding bytes never get into snapshot
+template <CLI_like CLI>
+constexpr std::size_t presented_snapshot_size() noexcept {
+  std::size_t size = sizeof(std::declval<typename CLI::presented_options&>().bits.words);
+  for_each_option<CLI>([&]<typename O>(O) { size += counts_occurrences<O>; });
+  return size;
+}
+
+template <CLI_like CLI>
+void write_presented(snapshot_writer& w, const typename CLI::presented_options& presented) noexcept {
+  w.write(presented.bits.words.data(), sizeof(presented.bits.words));
+  for_each_option<CLI>([&]<typename O>(O) {
+    if constexpr (counts_occurrences<O>)
+      w.write(&O::get(presented), sizeof(std::uint8_t));
+  });
+}
+
+template <CLI_like CLI>
+bool read_presented(snapshot_reader& r, typename CLI::presented_options& presented) noexcept {
+  auto& words = presented.bits.words;
+  bool ok = r.read(words.data(), sizeof(words));
+  // bits after last option are never set
+  constexpr std::size_t unused_bits = sizeof(words) * 8 - options_count<CLI>();
+  if constexpr (unused_bits != 0)
+    ok = ok && (words.back() >> (64 - unused_bits)) == 0;
+  for_each_option<CLI>([&]<typename O>(O) {
+    if constexpr (counts_occurrences<O>)
+      ok = ok && r.read(&O::get(presented), sizeof(std::uint8_t));
+  });
+  return ok;
+}
+
+}  // namespace noexport
+
+// hash of option names, types and order, snapshot is restored only by CLI with same hash
+template <CLI_like CLI>
+constexpr inline std::uint64_t snapshot_schema_hash = noexport::make_schema_hash<CLI>();
+
+template <CLI_like CLI>
+std::size_t snapshot_size(const typename CLI::options& opts) noexcept {
+  static_assert(!noexport::snapshot_free_args_view<CLI>,
+                "free_args_view cannot be restored from snapshot, use ALLOW_ADDITIONAL_ARGS");
+  std::size_t size = sizeof(noexport::snapshot_header) + noexport::presented_snapshot_size<CLI>();
+  for_each_option<CLI>([&]<typename O>(O) {
+    using T = cpp_type_t<O>;
+    static_assert(noexport::snapshot_value<T>,
+                  "option type may hold pointers or invalid bytes, specialize clinok::snapshot_restorable");
+    if constexpr (noexport::snapshot_string<T>)
+      size += sizeof(std::uint64_t) + std::string_view(O::get(opts)).size();
+    else
+      size += sizeof(T);
+  });
+  if constexpr (noexport::snapshot_free_args<CLI>) {
+    size += sizeof(std::uint64_t);
+    for (std::string_view a : opts.additional_args)
+      size += sizeof(std::uint64_t) + a.size();
+  }
+  return size;
+}
+
+// writes snapshot of 'opts' and 'presented' into 'out', e.g. into mapping of memfd shared with workers.
+// 'written' is set to snapshot size, which is also required size of 'out' if it is too small
+template <CLI_like CLI>
+[[nodiscard]] snapshot_errc save_snapshot(const typename CLI::options& opts,
+                                          const typename CLI::presented_options& presented,
+                                          std::span<char> out, std::size_t& written) noexcept {
+  written = snapshot_size<CLI>(opts);
+  if (out.size() < written)
+    return snapshot_errc::too_small;
+  noexport::snapshot_writer w{out.data()};
+  noexport::snapshot_header header{.schema = snapshot_schema_hash<CLI>, .size = written};
+  w.write(&header, sizeof(header));
+  noexport::write_presented<CLI>(w, presented);
+  for_each_option<CLI>([&]<typename O>(O) {
+    if constexpr (noexport::snapshot_string<cpp_type_t<O>>)
+      w.write_str(O::get(opts));
+    else
+      w.write(&O::get(opts), sizeof(cpp_type_t<O>));
+  });
+  if constexpr (noexport::snapshot_free_args<CLI>) {
+    std::uint64_t count = opts.additional_args.size();
+    w.write(&count, sizeof(count));
+    for (std::string_view a : opts.additional_args)
+      w.write_str(a);
+  }
+  return snapshot_errc::ok;
+}
+
+template <CLI_like CLI>
+std::vector<char> save_snapshot(const typename CLI::options& opts,
+                                const typename CLI::presented_options& presented) {
+  std::vector<char> out(snapshot_size<CLI>(opts));
+  std::size_t written;
+  (void)save_snapshot<CLI>(opts, presented, out, written);
+  return out;
+}
+
+// restores options saved by save_snapshot, costs O(snapshot size) and does not parse strings.
+// std::string_view options and free arguments point into 'snapshot', so it must outlive 'opts'.
+// 'opts' and 'presented' are unspecified on error
+template <CLI_like CLI>
+[[nodiscard]] snapshot_errc restore_snapshot(std::span<const char> snapshot, typename CLI::options& opts,
+                                             typename CLI::presented_options& presented) {
+  static_assert(!noexport::snapshot_free_args_view<CLI>,
+                "free_args_view cannot be restored from snapshot, use ALLOW_ADDITIONAL_ARGS");
+  noexport::snapshot_reader r{snapshot.data(), snapshot.data() + snapshot.size()};
+  noexport::snapshot_header header;
+  if (!r.read(&header, sizeof(header)) || std::memcmp(header.magic, noexport::snapshot_header{}.magic, 4))
+    return snapshot_errc::not_a_snapshot;
+  if (header.version != snapshot_format_version)
+    return snapshot_errc::version_mismatch;
+  if (header.schema != snapshot_schema_hash<CLI>)
+    return snapshot_errc::schema_mismatch;
+  if (header.size > snapshot.size() || header.size < sizeof(header))
+    return snapshot_errc::not_a_snapshot;
+  r.end = snapshot.data() + header.size;
+  bool ok = noexport::read_presented<CLI>(r, presented);
+  for_each_option<CLI>([&]<typename O>(O) {
+    static_assert(noexport::snapshot_value<cpp_type_t<O>>,
+                  "option type may hold pointers or invalid bytes, specialize clinok::snapshot_restorable");
+    if constexpr (std::same_as<cpp_type_t<O>, std::string_view>) {
+      ok = ok && r.read_str(O::get(opts));
+    } else if constexpr (std::same_as<cpp_type_t<O>, std::string>) {
+      std::string_view s;
+      ok = ok && r.read_str(s);
+      O::get(opts).assign(s);
+    } else {
+      ok = ok && r.read_value(O::get(opts));
+    }
+  });
+  if constexpr (noexport::snapshot_free_args<CLI>) {
+    std::uint64_t count = 0;
+    ok = ok && r.read(&count, sizeof(count));
+    opts.additional_args.clear();
+    // each argument takes at least its size, so 'count' from invalid snapshot does not reserve too much
+    if (ok)
+      opts.additional_args.reserve(std::min<std::uint64_t>(count, (r.end - r.pos) / sizeof(std::uint64_t)));
+    for (std::string_view a; ok && count != 0; --count) {
+      ok = r.read_str(a);
+      if (ok)
+        opts.additional_args.push_back(a);
+    }
+  }
+  return ok ? snapshot_errc::ok : snapshot_errc::not_a_snapshot;
+}
+
+}  // namespace clinok
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <charconv>
+#include <limits>
 #include <string>
 #include <string_view>
 
@@ -21,6 +22,14 @@ struct type_descriptor {
   // optional
   // used for help message, e.g. for enum "[red, green, blue]"
   // possible_values_description()
+
+  // optional
+  // all valid values, used to suggest value when invalid one passed
+  // possible_values() -> range of std::string_view
+
+  // optional
+  // writes arguments from which parse_option parses same value, used by to_args
+  // format(const T&, args_writer&)
 };
 
 template <std::integral T>
@@ -32,12 +41,17 @@ struct type_descriptor<T> {
       return "<int>";
   }
 
-  static args_t::iterator parse_option(args_t::iterator it, args_t::iterator end, T& out, errc& er) {
+  static constexpr args_t::iterator parse_option(args_t::iterator it, args_t::iterator end, T& out,
+                                                 errc& er) {
     if (it == end) {
       er = errc::argument_missing;
       return it;
     }
     std::string_view raw_arg = std::string_view(*it);
+    if (std::is_constant_evaluated()) {
+      er = parse_constexpr(raw_arg, out);
+      return ++it;
+    }
     er = [&] {
       auto [_, ec] = std::from_chars(raw_arg.data(), raw_arg.data() + raw_arg.size(), out);
       if (ec != std::errc{})
@@ -46,6 +60,31 @@ struct type_descriptor<T> {
     }();
     return ++it;
   }
+
+  static void format(T value, args_writer& out) noexcept {
+    char buf[std::numeric_limits<T>::digits10 + 3];
+    auto [end, _] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.push(std::string_view(buf, end));
+  }
+
+ private:
+  // std::from_chars is not constexpr in C++20, same behavior for default values parsed at compile time
+  static constexpr errc parse_constexpr(std::string_view s, T& out) noexcept {
+    const bool negative = std::signed_integral<T> && s.starts_with('-');
+    std::size_t i = negative;
+    if (i == s.size() || s[i] < '0' || s[i] > '9')
+      return errc::not_a_number;
+    T value = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+      T d = s[i] - '0';
+      if (negative ? value < (std::numeric_limits<T>::min() + d) / 10
+                   : value > (std::numeric_limits<T>::max() - d) / 10)
+        return errc::not_a_number;
+      value = negative ? value * 10 - d : value * 10 + d;
+    }
+    out = value;
+    return errc::ok;
+  }
 };
 
 template <>
@@ -76,6 +115,10 @@ struct type_descriptor<bool> {
 
     return ++it;
   }
+
+  static void format(bool value, args_writer& out) noexcept {
+    out.push(value ? "true" : "false");
+  }
 };
 
 template <>
@@ -90,9 +133,14 @@ struct type_descriptor<std::string> {
       er = errc::argument_missing;
       return it;
     }
-    out = std::string{*it};
+    // keeps capacity
+    out.assign(std::string_view(*it));
     return ++it;
   }
+
+  static void format(const std::string& value, args_writer& out) noexcept {
+    out.push(value);
+  }
 };
 
 template <>
@@ -101,8 +149,8 @@ struct type_descriptor<std::string_view> {
     return "<string>";
   }
 
-  static args_t::iterator parse_option(args_t::iterator it, args_t::iterator end, std::string_view& out,
-                                       errc& er) {
+  static constexpr args_t::iterator parse_option(args_t::iterator it, args_t::iterator end,
+                                                 std::string_view& out, errc& er) {
     if (it == end) {
       er = errc::argument_missing;
       return it;
@@ -110,6 +158,10 @@ struct type_descriptor<std::string_view> {
     out = std::string_view{*it};
     return ++it;
   }
+
+  static void format(std::string_view value, args_writer& out) noexcept {
+    out.push(value);
+  }
 };
 
 template <>
@@ -4,10 +4,22 @@
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <string>
 #include <span>
 #include <string_view>
+#include <vector>
+
+// rarely executed functions (errors, help), placed apart from hot code
+#if defined(__GNUC__) || defined(__clang__)
+  #define CLINOK_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+  #define CLINOK_COLD __declspec(noinline)
+#else
+  #define CLINOK_COLD
+#endif
 
 namespace clinok {
 
@@ -16,6 +28,34 @@ double levenshtein_distance(std::string_view a, std::string_view b);
 // takes into account the distance on the qwerty keyboard
 double damerau_levenshtein_distance(std::string_view a, std::string_view b);
 
+// same as damerau_levenshtein_distance(a, b), but stops when distance becomes greater then 'max_distance'
+// and returns infinity then. Costs O(max_distance * max(a.size(), b.size()))
+double damerau_levenshtein_distance(std::string_view a, std::string_view b, double max_distance);
+
+// bit-parallel, unweighted and case insensitive optimal string alignment distance (Hyyro).
+// Pattern preprocessed once and may be compared with many strings.
+// qwerty costs are >= 0.5, so 'distance(s) / 2.0' is a lower bound for
+// damerau_levenshtein_distance(pattern, s)
+struct osa_pattern {
+  explicit osa_pattern(std::string_view pattern) noexcept;
+
+  // false if pattern does not fit into machine word, distance cannot be computed then
+  bool valid() const noexcept {
+    return size <= 64;
+  }
+
+  // precondition: valid()
+  std::size_t distance(std::string_view s) const noexcept;
+
+  // same as 'out[i] = distance(s[i])', but computes several distances at once with SSE2 or AVX2.
+  // precondition: valid(), all 's' have same size
+  void distance(std::span<const std::string_view> s, std::size_t* out) const noexcept;
+
+ private:
+  std::uint64_t peq[256] = {};
+  std::size_t size = 0;
+};
+
 struct best_match_result_t {
   std::string found;
   double diff = std::numeric_limits<double>::max();
@@ -23,13 +63,23 @@ struct best_match_result_t {
 
 // returns the most similar string available
 // 'possibles' should be range of string_view convertible values
-[[nodiscard]] best_match_result_t best_match_str(std::string_view str, auto&& possibles) {
+// strings with distance >= 'max_diff' are ignored, so cost of search is bounded even for very long 'str'
+[[nodiscard]] best_match_result_t best_match_str(
+    std::string_view str, auto&& possibles, double max_diff = std::numeric_limits<double>::infinity()) {
   best_match_result_t res;
+  osa_pattern pattern(str);
 
   // min_element with storing 'diff'
   for (std::string_view alt : possibles) {
-    double d = damerau_levenshtein_distance(str, alt);
-    if (d < res.diff) {
+    double bound = std::min(res.diff, max_diff);
+    // each inserted or deleted char costs 1
+    if ((str.size() > alt.size() ? str.size() - alt.size() : alt.size() - str.size()) >= bound)
+      continue;
+    // cheap lower bound skips most of candidates
+    if (pattern.valid() && pattern.distance(alt) / 2.0 >= bound)
+      continue;
+    double d = damerau_levenshtein_distance(str, alt, bound);
+    if (d < bound) {
       res.diff = d;
       res.found = alt;
     }
@@ -38,14 +88,46 @@ struct best_match_result_t {
   return res;
 }
 
+struct suggestion {
+  std::string_view str;
+  double diff = std::numeric_limits<double>::max();
+  // index of 'str' in candidates list passed to suggestion_index
+  std::size_t index = 0;
+};
+
+// index for fast search of similar strings, built once for fixed list of candidates.
+// Gives same results as best_match_str, but skips candidates by length and bit-parallel lower bound
+// instead of computing distance to each
+struct suggestion_index {
+  suggestion_index() = default;
+  explicit suggestion_index(std::vector<std::string> candidates);
+
+  // fills 'out' with up to out.size() candidates closest to 'str' with distance < 'max_diff'.
+  // Result sorted by distance, candidates with same distance in order of passed candidates list.
+  // returns count of found candidates
+  std::size_t suggest(std::string_view str, double max_diff, std::span<suggestion> out) const;
+
+ private:
+  struct entry {
+    std::string str;
+    std::size_t index;
+  };
+  // sorted by length
+  std::vector<entry> entries;
+  // entries with length 'l' are in [length_begin[l], length_begin[l + 1])
+  std::vector<std::size_t> length_begin;
+};
+
 using arg = const char*;
 
 using args_t = std::span<const arg>;
 
 // context of current parsing
+// views into parsed arguments or static option names, see error_code::own
 struct context {
-  std::string typed;          // what user typed (includeing -- or -)
-  std::string resolved_name;  // resolved alias or just name
+  std::string_view typed;          // what user typed (includeing -- or -)
+  std::string_view resolved_name;  // resolved alias or just name
+  std::string_view value = {};     // last argument of option consumed before error, if any
 };
 
 enum struct errc {
@@ -58,25 +140,110 @@ enum struct errc {
   disallowed_free_arg,
   not_a_number,                 // parse int argument impossible
   required_option_not_present,  // option without default value not present in arguments
+  // '@file' passed, ALLOW_RESPONSE_FILES present in declarations file, but file cannot be read
+  invalid_response_file,
+  // config file cannot be read or has invalid line
+  invalid_config_file,
 };
 
 std::string_view e2str(errc) noexcept;
 
+// does not allocate memory until 'own' called
 struct error_code {
   errc what = errc::ok;
   context ctx;
 
+  constexpr error_code() = default;
+
+  constexpr error_code(const error_code& other) : what(other.what), ctx(other.ctx), owns(other.owns) {
+    if (owns) {
+      storage = other.storage;
+      rebind();
+    }
+  }
+
+  constexpr error_code(error_code&& other) noexcept : what(other.what), ctx(other.ctx), owns(other.owns) {
+    if (owns) {
+      storage = std::move(other.storage);
+      rebind();
+      other.release_context();
+    }
+  }
+
+  constexpr error_code& operator=(const error_code& other) {
+    if (this != &other) {
+      what = other.what;
+      ctx = other.ctx;
+      owns = other.owns;
+      if (owns) {
+        storage = other.storage;
+        rebind();
+      }
+    }
+    return *this;
+  }
+
+  constexpr error_code& operator=(error_code&& other) noexcept {
+    if (this != &other) {
+      what = other.what;
+      ctx = other.ctx;
+      owns = other.owns;
+      if (owns) {
+        storage = std::move(other.storage);
+        rebind();
+        other.release_context();
+      }
+    }
+    return *this;
+  }
+
   constexpr void set_error(errc ec, context ctx_) noexcept {
     what = ec;
-    ctx = std::move(ctx_);
+    ctx = ctx_;
+    owns = false;
   }
   constexpr void clear() noexcept {
     what = errc::ok;
     ctx = {};
+    owns = false;
+  }
+  // copies context strings into error_code, so it may be used after parsed arguments destroyed
+  constexpr void own() {
+    if (owns)
+      return;
+    storage.assign(ctx.typed).append(ctx.resolved_name).append(ctx.value);
+    owns = true;
+    rebind();
+  }
+  constexpr bool owns_context() const noexcept {
+    return owns;
   }
   constexpr explicit operator bool() const noexcept {
     return what != errc::ok;
   }
+
+ private:
+  constexpr void rebind() noexcept {
+    std::string_view s = storage;
+    // e.g. storage of moved-from error_code
+    if (s.size() < ctx.typed.size() + ctx.resolved_name.size() + ctx.value.size()) {
+      release_context();
+      return;
+    }
+    ctx.value = s.substr(ctx.typed.size() + ctx.resolved_name.size());
+    ctx.resolved_name = s.substr(ctx.typed.size(), ctx.resolved_name.size());
+    ctx.typed = s.substr(0, ctx.typed.size());
+  }
+
+  // context pointed into storage, which is moved or invalid
+  constexpr void release_context() noexcept {
+    ctx = {};
+    owns = false;
+  }
+
+  // typed + resolved_name + value when 'owns'
+  std::string storage;
+  bool owns = false;
 };
 
 // assumes first arg as program name
@@ -84,6 +251,207 @@ constexpr inline args_t args_range(int argc, const arg* argv) noexcept {
   return args_t(argv, argv + argc);
 }
 
+// free arguments without copying them: runs of consecutive free arguments in parsed args.
+// Usually free arguments are contiguous (e.g. ninja -C dir a b c), then view is a single args_t
+// and nothing is allocated
+struct free_args_view {
+  struct iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using reference = std::string_view;
+    using difference_type = std::ptrdiff_t;
+
+    const free_args_view* view = nullptr;
+    std::size_t run = 0;
+    const arg* pos = nullptr;
+
+    constexpr std::string_view operator*() const noexcept {
+      return *pos;
+    }
+    constexpr iterator& operator++() noexcept {
+      ++pos;
+      if (pos == std::to_address(view->run(run).end())) {
+        ++run;
+        pos = run < view->runs_count() ? view->run(run).data() : nullptr;
+      }
+      return *this;
+    }
+    constexpr iterator operator++(int) noexcept {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    constexpr bool operator==(const iterator&) const = default;
+  };
+
+  constexpr iterator begin() const noexcept {
+    return iterator{this, 0, empty() ? nullptr : first.data()};
+  }
+  constexpr iterator end() const noexcept {
+    return iterator{this, runs_count(), nullptr};
+  }
+  constexpr std::size_t size() const noexcept {
+    return count;
+  }
+  constexpr bool empty() const noexcept {
+    return count == 0;
+  }
+  // costs O(runs_count())
+  constexpr std::string_view operator[](std::size_t i) const noexcept {
+    assert(i < count);
+    std::size_t r = 0;
+    for (; i >= run(r).size(); ++r)
+      i -= run(r).size();
+    return run(r)[i];
+  }
+
+  constexpr std::size_t runs_count() const noexcept {
+    return empty() ? 0 : 1 + other_runs.size();
+  }
+  constexpr args_t run(std::size_t i) const noexcept {
+    return i == 0 ? first : other_runs[i - 1];
+  }
+  // true if all free arguments are consecutive in parsed args, 'as_args' is valid then
+  constexpr bool contiguous() const noexcept {
+    return other_runs.empty();
+  }
+  constexpr args_t as_args() const noexcept {
+    assert(contiguous());
+    return first;
+  }
+  std::vector<std::string_view> to_vector() const {
+    return std::vector<std::string_view>(begin(), end());
+  }
+
+  // adds '*pos' to view, 'pos' must point after previously added arguments of same args
+  constexpr void push(const arg* pos) {
+    args_t& last = other_runs.empty() ? first : other_runs.back();
+    if (empty())
+      first = args_t(pos, 1);
+    else if (std::to_address(last.end()) == pos)
+      last = args_t(last.data(), last.size() + 1);
+    else
+      other_runs.push_back(args_t(pos, 1));
+    ++count;
+  }
+  // keeps capacity
+  constexpr void clear() noexcept {
+    first = {};
+    other_runs.clear();
+    count = 0;
+  }
+
+  constexpr bool operator==(const free_args_view& other) const noexcept {
+    return count == other.count && std::equal(begin(), end(), other.begin());
+  }
+
+ private:
+  args_t first;
+  std::vector<args_t> other_runs;
+  std::size_t count = 0;
+};
+
+enum struct split_errc {
+  ok,
+  unterminated_quote,  // ' or " without closing quote
+  too_many_args,       // 'out' has not enough space, first 'out.size()' arguments are written
+};
+
+struct split_result {
+  std::size_t count = 0;  // arguments written into 'out'
+  split_errc what = split_errc::ok;
+
+  constexpr explicit operator bool() const noexcept {
+    return what == split_errc::ok;
+  }
+};
+
+// splits 'cmd' into arguments as POSIX shell does, without any expansions:
+// arguments are separated by spaces, tabs, '\r' and newlines, '' quotes everything, \ outside of quotes
+// escapes any char, inside "" escapes only $ ` " \ and newline, \<newline> is removed.
+// Unescapes in place and null-terminates arguments inside 'cmd', 'out' points into 'cmd', nothing allocated.
+// 'cmd[size]' must be writable, e.g. std::string::data().
+// 'size / 2 + 1' arguments is always enough.
+// Note: result does not contain program name, reserve 'out[0]' for it before passing to 'parse'
+[[nodiscard]] split_result split_command_line(char* cmd, std::size_t size, std::span<arg> out) noexcept;
+
+namespace noexport {
+
+// tokenizer of split_command_line, also used for response files and config values
+
+enum struct split_step { none, arg, unterminated_quote };
+
+struct split_token {
+  // unescaped argument, not null-terminated
+  char* begin = nullptr;
+  char* end = nullptr;
+  // argument is ended by end of input, not by separator, so it may continue in next chunk of input
+  bool at_end = false;
+};
+
+// unescapes next argument of [in, end) in place and moves 'in' after it and its separator.
+// 'end' is not written, so '*out.end' may be written only if 'out.end != end'
+split_step split_next_arg(char*& in, char* end, split_token& out) noexcept;
+// same as split_next_arg, but does not write, 'out' is bounds of argument as it would be unescaped
+split_step skip_next_arg(char*& in, char* end, split_token& out) noexcept;
+
+}  // namespace noexport
+
+// writes null-terminated arguments into 'chars' and pointers to them into 'args', nothing allocated.
+// 'args' is always terminated by nullptr, so may be passed to execv.
+// If buffers are too small, nothing is written after first argument which does not fit,
+// but all arguments are counted in required sizes, so caller may grow buffers and write again
+struct args_writer {
+  args_writer(std::span<char> chars, std::span<arg> args) noexcept : chars(chars), args_(args) {
+    if (!args_.empty())
+      args_[0] = nullptr;
+  }
+
+  void push(std::string_view s) noexcept {
+    push(std::string_view{}, s);
+  }
+  // pushes concatenation of 'prefix' and 's' as one argument, e.g. "--" and option name
+  void push(std::string_view prefix, std::string_view s) noexcept {
+    std::size_t size = prefix.size() + s.size();
+    // + 1 for '\0' and for terminating nullptr
+    if (chars_count + size + 1 <= chars.size() && args_count + 2 <= args_.size() && !overflow) {
+      char* p = chars.data() + chars_count;
+      std::copy(s.begin(), s.end(), std::copy(prefix.begin(), prefix.end(), p));
+      p[size] = '\0';
+      args_[args_count] = p;
+      args_[args_count + 1] = nullptr;
+    } else {
+      overflow = true;
+    }
+    chars_count += size + 1;
+    ++args_count;
+  }
+
+  // false if some arguments do not fit
+  explicit operator bool() const noexcept {
+    return !overflow;
+  }
+  // written arguments, without terminating nullptr
+  args_t args() const noexcept {
+    return overflow ? args_t{} : args_t(args_.data(), args_count);
+  }
+  // required size of 'chars'
+  std::size_t chars_needed() const noexcept {
+    return chars_count;
+  }
+  // required size of 'args', including terminating nullptr
+  std::size_t args_needed() const noexcept {
+    return args_count + 1;
+  }
+
+ private:
+  std::span<char> chars;
+  std::span<arg> args_;
+  std::size_t chars_count = 0;
+  std::size_t args_count = 0;
+  bool overflow = false;
+};
+
 template <typename...>
 struct typelist {};
 
@@ -0,0 +1,226 @@
+
+#include <clinok/config_file.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <stdlib.h>
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+extern char** environ;
+#endif
+
+namespace clinok {
+
+namespace {
+
+constexpr bool is_blank(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::pair<char*, char*> trim_blanks(char* b, char* e) noexcept {
+  while (b != e && is_blank(*b))
+    ++b;
+  while (b != e && is_blank(e[-1]))
+    --e;
+  return {b, e};
+}
+
+}  // namespace
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : ptr(std::exchange(other.ptr, nullptr)), len(std::exchange(other.len, 0)) {
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+  if (this != &other) {
+    close();
+    ptr = std::exchange(other.ptr, nullptr);
+    len = std::exchange(other.len, 0);
+  }
+  return *this;
+}
+
+mapped_file::~mapped_file() {
+  close();
+}
+
+bool mapped_file::open(const char* path) noexcept {
+  close();
+#ifdef _WIN32
+  HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                         nullptr);
+  if (f == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(f, &size)) {
+    CloseHandle(f);
+    return false;
+  }
+  if (size.QuadPart == 0) {
+    CloseHandle(f);
+    return true;
+  }
+  HANDLE m = CreateFileMappingA(f, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(f);
+  if (!m)
+    return false;
+  void* p = MapViewOfFile(m, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(m);
+  if (!p)
+    return false;
+  ptr = static_cast<char*>(p);
+  len = size.QuadPart;
+#else
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    return true;
+  }
+  // private writable mapping, so arguments may be unescaped and null-terminated in place
+  void* p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return false;
+  ptr = static_cast<char*>(p);
+  len = st.st_size;
+#endif
+  return true;
+}
+
+void mapped_file::close() noexcept {
+  if (!ptr)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(ptr);
+#else
+  munmap(ptr, len);
+#endif
+  ptr = nullptr;
+  len = 0;
+}
+
+void config_file::reset() noexcept {
+  file.close();
+  buffer.reset();
+  tail.reset();
+  args.clear();
+  entries_.clear();
+  failed = 0;
+}
+
+bool config_file::open(const char* path, std::string_view section) {
+  reset();
+  if (!file.open(path))
+    return false;
+  return parse(file.data(), file.data() + file.size(), section, false);
+}
+
+bool config_file::read(const char* path, std::string_view section) {
+  reset();
+  std::error_code ec;
+  std::size_t size = std::filesystem::file_size(path, ec);
+  if (ec)
+    return false;
+  std::FILE* f = std::fopen(path, "rb");
+  if (!f)
+    return false;
+  std::setvbuf(f, nullptr, _IONBF, 0);
+  // + 1 for '\0' after last value
+  buffer = std::make_unique<char[]>(size + 1);
+  // file may be truncated while reading
+  size = std::fread(buffer.get(), 1, size, f);
+  bool ok = !std::ferror(f);
+  std::fclose(f);
+  return ok && parse(buffer.get(), buffer.get() + size, section, true);
+}
+
+bool config_file::parse(char* b, char* const e, std::string_view section, bool end_writable) {
+  // index of first value of each entry in 'args', which may be reallocated until end of file
+  std::vector<std::size_t> first_value;
+  auto fail = [&](std::size_t line) {
+    entries_.clear();
+    failed = line;
+    return false;
+  };
+
+  // usually one entry per line and one argument per entry
+  std::size_t lines_count = std::count(b, e, '\n') + 1;
+  first_value.reserve(lines_count);
+  entries_.reserve(lines_count);
+  args.reserve(lines_count);
+  // entries before first section are always read
+  bool in_section = true;
+  for (std::size_t line = 1; b != e; ++line) {
+    char* nl = static_cast<char*>(std::memchr(b, '\n', e - b));
+    auto [lb, le] = trim_blanks(b, nl ? nl : e);
+    b = nl ? nl + 1 : e;
+    if (lb == le || *lb == '#' || *lb == ';')
+      continue;
+    if (*lb == '[') {
+      if (le[-1] != ']' || le - lb < 2)
+        return fail(line);
+      auto [sb, se] = trim_blanks(lb + 1, le - 1);
+      in_section = std::string_view(sb, se - sb) == section;
+      continue;
+    }
+    char* eq = static_cast<char*>(std::memchr(lb, '=', le - lb));
+    if (!eq)
+      return fail(line);
+    auto [kb, ke] = trim_blanks(lb, eq);
+    if (kb == ke)
+      return fail(line);
+    if (!in_section)
+      continue;
+    auto [vb, ve] = trim_blanks(eq + 1, le);
+    std::size_t size = ve - vb;
+    char* value = vb;
+    if (ve == e && !end_writable) {
+      // no place for '\0' in mapping
+      tail = std::make_unique<char[]>(size + 1);
+      std::copy(vb, ve, tail.get());
+      value = tail.get();
+    }
+    std::size_t first = args.size();
+    args.resize(first + size / 2 + 1);
+    split_result r = split_command_line(value, size, std::span(args).subspan(first));
+    if (!r)
+      return fail(line);
+    args.resize(first + r.count);
+    entries_.push_back(entry{std::string_view(kb, ke - kb), {}, line});
+    first_value.push_back(first);
+  }
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    std::size_t last = i + 1 < entries_.size() ? first_value[i + 1] : args.size();
+    entries_[i].values = args_t(args).subspan(first_value[i], last - first_value[i]);
+  }
+  return true;
+}
+
+const char* const* current_environment() noexcept {
+#ifdef _WIN32
+  return _environ;
+#else
+  return environ;
+#endif
+}
+
+}  // namespace clinok
@@ -0,0 +1,99 @@
+
+#include <clinok/file_watcher.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+  #include <poll.h>
+  #include <sys/eventfd.h>
+  #include <sys/inotify.h>
+  #include <unistd.h>
+#endif
+
+namespace clinok {
+
+file_watcher::file_watcher(std::string path, std::function<void()> on_change_,
+                           std::chrono::milliseconds poll_interval_)
+    : file_path(std::move(path)), on_change(std::move(on_change_)), poll_interval(poll_interval_) {
+#ifdef __linux__
+  wake_fd = eventfd(0, EFD_CLOEXEC);
+  if (wake_fd >= 0) {
+    thread = std::thread([this] { run_inotify(); });
+    return;
+  }
+#endif
+  thread = std::thread([this] { run_polling(); });
+}
+
+file_watcher::~file_watcher() {
+  stop_requested = true;
+#ifdef __linux__
+  if (wake_fd >= 0) {
+    std::uint64_t one = 1;
+    (void)!write(wake_fd, &one, sizeof(one));
+  }
+#endif
+  thread.join();
+#ifdef __linux__
+  if (wake_fd >= 0)
+    close(wake_fd);
+#endif
+}
+
+void file_watcher::run_polling() {
+  std::error_code ec;
+  auto last = std::filesystem::last_write_time(file_path, ec);
+  while (!stop_requested) {
+    std::this_thread::sleep_for(poll_interval);
+    auto t = std::filesystem::last_write_time(file_path, ec);
+    if (!ec && t != last) {
+      last = t;
+      on_change();
+    }
+  }
+}
+
+void file_watcher::run_inotify() {
+#ifdef __linux__
+  std::filesystem::path p(file_path);
+  // directory is watched, so replacing file by rename is noticed too
+  std::string dir = p.has_parent_path() ? p.parent_path().string() : ".";
+  std::string name = p.filename().string();
+  int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+  if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    if (fd >= 0)
+      close(fd);
+    run_polling();
+    return;
+  }
+  alignas(inotify_event) char buf[4096];
+  pollfd fds[2] = {{fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+  while (!stop_requested) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+    bool changed = false;
+    for (ssize_t n; (n = read(fd, buf, sizeof(buf))) > 0;) {
+      for (char* e = buf; e < buf + n;) {
+        auto* event = reinterpret_cast<inotify_event*>(e);
+        if (event->len != 0 && name == event->name)
+          changed = true;
+        e += sizeof(inotify_event) + event->len;
+      }
+    }
+    // several events of one write are coalesced into one call
+    if (changed)
+      on_change();
+  }
+  close(fd);
+#endif
+}
+
+}  // namespace clinok
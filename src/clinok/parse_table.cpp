@@ -0,0 +1,63 @@
+
+#include <clinok/cli.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace clinok::noexport {
+
+namespace {
+
+CLINOK_COLD bool set_table_parse_error(error_code& ec, bool own_context, std::string_view typed, errc what,
+                                       std::string_view resolved, std::string_view value = {}) {
+  ec.set_error(what, context{typed, resolved, value});
+  if (own_context)
+    ec.own();
+  return false;
+}
+
+}  // namespace
+
+bool parse_with_table(const parse_table& table, args_t args, void* opts, void* presented,
+                      std::uint64_t* presented_bits, bool own_context, error_code& ec) noexcept {
+  char* const opts_bytes = static_cast<char*>(opts);
+  char* const presented_bytes = static_cast<char*>(presented);
+  errc er = errc::ok;
+
+  // skip program name
+  for (auto it = args.begin() + 1; it != args.end();) {
+    std::string_view typed = *it;
+    ++it;
+    resolved_arg r = table.resolve(typed);
+    if (r.what != errc::ok) [[unlikely]]
+      return set_table_parse_error(ec, own_context, typed, r.what, r.name);
+    if (r.free_arg) {
+      if (table.add_free_arg)
+        table.add_free_arg(opts, it - 1);
+      continue;
+    }
+
+    const table_option& o = table.options[r.option_index];
+    void* field = opts_bytes + o.offset;
+    // option parsed as if there were no default value
+    std::uint64_t& word = presented_bits[r.option_index / 64];
+    std::uint64_t bit = std::uint64_t(1) << (r.option_index % 64);
+    if (!(word & bit)) {
+      word |= bit;
+      o.reset(field);
+    }
+    if (o.counter_offset != table_option::npos) {
+      auto& c = *reinterpret_cast<std::uint8_t*>(presented_bytes + o.counter_offset);
+      c += c != std::numeric_limits<std::uint8_t>::max();
+    }
+    const auto values_begin = it;
+    it = o.parse(field, it, args.end(), er);
+    if (er != errc::ok) [[unlikely]] {
+      return set_table_parse_error(ec, own_context, typed, er, r.name,
+                                   it != values_begin ? std::string_view(*(it - 1)) : std::string_view{});
+    }
+  }
+  return true;
+}
+
+}  // namespace clinok::noexport
@@ -0,0 +1,103 @@
+#include <clinok/response_file.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace clinok {
+
+bool expand_response_files(args_t args, response_files& out, arg& failed) {
+  auto storage = std::make_shared<noexport::response_files_storage>();
+  noexport::response_files_storage& s = *storage;
+  s.args.reserve(args.size());
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    arg a = args[i];
+    if (i == 0 || a[0] != '@') {
+      s.args.push_back(a);
+      continue;
+    }
+    mapped_file f;
+    if (!f.open(a + 1)) {
+      failed = a;
+      return false;
+    }
+    char* in = f.data();
+    char* const e = in + f.size();
+    using noexport::split_step;
+    noexport::split_token t;
+    for (split_step step; (step = noexport::split_next_arg(in, e, t)) != split_step::none;) {
+      if (step == split_step::unterminated_quote) {
+        failed = a;
+        return false;
+      }
+      if (t.end != e) {
+        *t.end = '\0';
+        s.args.push_back(t.begin);
+      } else {
+        // no place for '\0' in mapping
+        std::size_t len = t.end - t.begin;
+        auto& tail = s.tails.emplace_back(new char[len + 1]);
+        std::copy(t.begin, t.end, tail.get());
+        tail[len] = '\0';
+        s.args.push_back(tail.get());
+      }
+    }
+    s.files.push_back(std::move(f));
+  }
+  out.storage = std::move(storage);
+  return true;
+}
+
+response_file_reader::response_file_reader(const char* path, std::size_t chunk_size)
+    : file(std::fopen(path, "rb")), buf(std::max<std::size_t>(chunk_size, 2)) {
+}
+
+response_file_reader::~response_file_reader() {
+  if (file)
+    std::fclose(file);
+}
+
+bool response_file_reader::next(std::string_view& out) {
+  if (!file || failed_)
+    return false;
+  using noexport::split_step;
+  for (;;) {
+    char* in = buf.data() + b;
+    char* const end = buf.data() + e;
+    noexport::split_token t;
+    // argument is unescaped only when it is complete, so bytes are not changed before reading more
+    split_step step = noexport::skip_next_arg(in, end, t);
+    if (step == split_step::none) {
+      b = e;
+      if (eof)
+        return false;
+    } else if (eof || (step == split_step::arg && !t.at_end)) {
+      if (step == split_step::unterminated_quote) {
+        failed_ = true;
+        return false;
+      }
+      in = buf.data() + b;
+      (void)noexport::split_next_arg(in, end, t);
+      out = std::string_view(t.begin, t.end - t.begin);
+      b = in - buf.data();
+      return true;
+    }
+    // argument may continue in next chunk, read more
+    if (b == 0 && e == buf.size()) {
+      buf.resize(buf.size() * 2);
+    } else {
+      std::copy(buf.data() + b, buf.data() + e, buf.data());
+      e -= b;
+      b = 0;
+    }
+    std::size_t n = std::fread(buf.data() + e, 1, buf.size() - e, file);
+    // end of file or read error
+    eof = n != buf.size() - e;
+    if (eof && std::ferror(file))
+      failed_ = true;
+    e += n;
+    if (failed_)
+      return false;
+  }
+}
+
+}  // namespace clinok
@@ -1,84 +1,153 @@
 
 #include <clinok/utils.hpp>
 
+#include <array>
 #include <vector>
 #include <cstring>
 #include <algorithm>
 #include <charconv>
-#include <unordered_map>
-#include <cmath>
+#include <tuple>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define CLINOK_SSE2
+#endif
+
+// AVX2 path of osa_pattern is compiled for target and selected at runtime if not enabled for whole build
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define CLINOK_AVX2
+  #define CLINOK_AVX2_TARGET
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define CLINOK_AVX2
+  #define CLINOK_AVX2_TARGET [[gnu::target("avx2")]]
+  #define CLINOK_AVX2_RUNTIME_CHECK
+#endif
+
+// tokenizer loop is inlined into split_command_line and response file readers
+#if defined(__GNUC__)
+  #define CLINOK_SPLIT_INLINE [[gnu::always_inline]] inline
+#elif defined(_MSC_VER)
+  #define CLINOK_SPLIT_INLINE __forceinline
+#else
+  #define CLINOK_SPLIT_INLINE inline
+#endif
 
 namespace clinok {
 
-static double qwerty_cost(char a, char b) {
-  // Приводим символы к нижнему регистру
-  a = std::tolower(a);
-  b = std::tolower(b);
+namespace {
 
+constexpr std::array<unsigned char, 256> lower_chars = [] {
+  std::array<unsigned char, 256> chars;
+  for (std::size_t c = 0; c < 256; ++c)
+    chars[c] = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+  return chars;
+}();
+
+constexpr unsigned char to_lower(char c) noexcept {
+  return lower_chars[static_cast<unsigned char>(c)];
+}
+
+// index of key on qwerty keyboard + 1, 0 for chars not on keyboard
+constexpr std::array<std::uint8_t, 256> qwerty_keys = [] {
+  std::array<std::uint8_t, 256> keys{};
+  std::string_view rows[] = {"1234567890", "qwertyuiop", "asdfghjkl", "zxcvbnm"};
+  std::uint8_t id = 0;
+  for (std::string_view row : rows) {
+    for (char c : row) {
+      ++id;
+      keys[static_cast<unsigned char>(c)] = id;
+      if (c >= 'a' && c <= 'z')
+        keys[static_cast<unsigned char>(c - 'a' + 'A')] = id;
+    }
+  }
+  return keys;
+}();
+
+constexpr std::size_t qwerty_keys_count = 10 + 10 + 9 + 7 + 1;
+
+// |x - y * y| without rounding error of the product (Dekker), 'y' must be close to sqrt(x)
+constexpr double sqrt_residual(double x, double y) noexcept {
+  double t = 134217729.0 * y;
+  double hi = t - (t - y);
+  double lo = y - hi;
+  double p = y * y;
+  double r = (x - p) - (((hi * hi - p) + 2 * hi * lo) + lo * lo);
+  return r < 0 ? -r : r;
+}
+
+// correctly rounded as std::sqrt, which is not constexpr
+constexpr double constexpr_sqrt(double x) noexcept {
+  if (x <= 0)
+    return 0;
+  double y = x < 1 ? 1 : x;
+  // Newton iteration decreases to sqrt(x) and stops near it
+  for (double next = (y + x / y) / 2; next < y; next = (y + x / y) / 2)
+    y = next;
+  auto neighbour = [](double d, std::int64_t dir) {
+    return std::bit_cast<double>(std::bit_cast<std::int64_t>(d) + dir);
+  };
+  for (double c : {neighbour(y, -1), neighbour(y, 1)}) {
+    if (sqrt_residual(x, c) < sqrt_residual(x, y))
+      y = c;
+  }
+  return y;
+}
+
+static_assert(constexpr_sqrt(4) == 2 && constexpr_sqrt(2) == 1.4142135623730951);
+
+// half of distance between keys on qwerty keyboard, 1 if any of keys is not on keyboard
+constexpr std::array<std::array<double, qwerty_keys_count>, qwerty_keys_count> qwerty_costs = [] {
+  std::string_view rows[] = {"1234567890", "qwertyuiop", "asdfghjkl", "zxcvbnm"};
+  std::array<std::pair<int, int>, qwerty_keys_count> coords{};
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < int(rows[row].size()); ++col)
+      coords[qwerty_keys[static_cast<unsigned char>(rows[row][col])]] = {row, col};
+  }
+  std::array<std::array<double, qwerty_keys_count>, qwerty_keys_count> c{};
+  for (std::size_t a = 0; a < qwerty_keys_count; ++a) {
+    for (std::size_t b = 0; b < qwerty_keys_count; ++b) {
+      if (a == 0 || b == 0) {
+        c[a][b] = 1.0;
+        continue;
+      }
+      int row_diff = coords[a].first - coords[b].first;
+      int col_diff = coords[a].second - coords[b].second;
+      c[a][b] = constexpr_sqrt(row_diff * row_diff + col_diff * col_diff) / 2.0;
+    }
+  }
+  return c;
+}();
+
+// takes into account the distance on the qwerty keyboard.
+// Same letters in different case have same key, so only chars not on keyboard need comparison
+constexpr double qwerty_cost(char a, char b) noexcept {
   if (a == b)
     return 0.0;
+  return qwerty_costs[qwerty_keys[static_cast<unsigned char>(a)]][qwerty_keys[static_cast<unsigned char>(b)]];
+}
 
-  // coordinates of keys on qwerty keyboard
-  static const std::unordered_map<char, std::pair<int, int>> qwerty_coords = {
-      // digits
-      {'1', {0, 0}},
-      {'2', {0, 1}},
-      {'3', {0, 2}},
-      {'4', {0, 3}},
-      {'5', {0, 4}},
-      {'6', {0, 5}},
-      {'7', {0, 6}},
-      {'8', {0, 7}},
-      {'9', {0, 8}},
-      {'0', {0, 9}},
-
-      // qwertyuiop
-      {'q', {1, 0}},
-      {'w', {1, 1}},
-      {'e', {1, 2}},
-      {'r', {1, 3}},
-      {'t', {1, 4}},
-      {'y', {1, 5}},
-      {'u', {1, 6}},
-      {'i', {1, 7}},
-      {'o', {1, 8}},
-      {'p', {1, 9}},
-
-      // asdfghjkl
-      {'a', {2, 0}},
-      {'s', {2, 1}},
-      {'d', {2, 2}},
-      {'f', {2, 3}},
-      {'g', {2, 4}},
-      {'h', {2, 5}},
-      {'j', {2, 6}},
-      {'k', {2, 7}},
-      {'l', {2, 8}},
-
-      // zxcvbnm
-      {'z', {3, 0}},
-      {'x', {3, 1}},
-      {'c', {3, 2}},
-      {'v', {3, 3}},
-      {'b', {3, 4}},
-      {'n', {3, 5}},
-      {'m', {3, 6}},
-  };
+static_assert(qwerty_cost('a', 'A') == 0 && qwerty_cost('q', 'w') == 0.5 && qwerty_cost('-', '_') == 1);
 
-  auto it_a = qwerty_coords.find(a);
-  auto it_b = qwerty_coords.find(b);
+// rows of DP matrix, placed on stack for short strings
+struct dp_rows {
+  static constexpr std::size_t inplace_size = 64;
 
-  if (it_a == qwerty_coords.end() || it_b == qwerty_coords.end())
-    return 1.0;
+  std::array<double, inplace_size * 3> inplace;
+  std::vector<double> heap;
 
-  const auto& [row_a, col_a] = it_a->second;
-  const auto& [row_b, col_b] = it_b->second;
+  explicit dp_rows(std::size_t row_size) {
+    if (row_size > inplace_size)
+      heap.resize(row_size * 3);
+  }
+  double* data() noexcept {
+    return heap.empty() ? inplace.data() : heap.data();
+  }
+};
 
-  double row_diff = row_a - row_b;
-  double col_diff = col_a - col_b;
-  double distance = std::sqrt(row_diff * row_diff + col_diff * col_diff);
-  return distance / 2.0;
-}
+}  // namespace
 
 double levenshtein_distance(std::string_view a, std::string_view b) {
   const size_t m = a.size();
@@ -89,8 +158,9 @@ double levenshtein_distance(std::string_view a, std::string_view b) {
   if (n == 0)
     return m;
 
-  std::vector<double> prev_row(n + 1);
-  std::vector<double> curr_row(n + 1);
+  dp_rows rows(n + 1);
+  double* prev_row = rows.data();
+  double* curr_row = prev_row + n + 1;
 
   for (size_t i = 0; i <= n; ++i) {
     prev_row[i] = i;
@@ -100,55 +170,295 @@ double levenshtein_distance(std::string_view a, std::string_view b) {
     curr_row[0] = i;
 
     for (size_t j = 1; j <= n; ++j) {
-      double cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
-
-      curr_row[j] =
-          std::min({prev_row[j] + 1, curr_row[j - 1] + 1, prev_row[j - 1] + qwerty_cost(a[i - 1], b[j - 1])});
+      curr_row[j] = std::min(
+          {prev_row[j] + 1, curr_row[j - 1] + 1, prev_row[j - 1] + qwerty_cost(a[i - 1], b[j - 1])});
     }
 
-    prev_row.swap(curr_row);
+    std::swap(prev_row, curr_row);
   }
 
   return prev_row[n];
 }
 
 double damerau_levenshtein_distance(std::string_view a, std::string_view b) {
+  return damerau_levenshtein_distance(a, b, std::numeric_limits<double>::infinity());
+}
+
+double damerau_levenshtein_distance(std::string_view a, std::string_view b, double max_distance) {
+  constexpr double inf = std::numeric_limits<double>::infinity();
   const size_t m = a.size();
   const size_t n = b.size();
 
+  // each inserted or deleted char costs 1
+  if ((m > n ? m - n : n - m) > max_distance)
+    return inf;
   if (m == 0)
     return n;
   if (n == 0)
     return m;
 
-  std::vector<double> prev_prev_row(n + 1);
-  std::vector<double> prev_row(n + 1);
-  std::vector<double> curr_row(n + 1);
+  // cells with |i - j| > k cost more then 'max_distance', only band around diagonal is computed
+  const size_t k = max_distance >= double(m + n) ? m + n : size_t(max_distance);
+  dp_rows rows(n + 1);
+  double* prev_prev_row = rows.data();
+  double* prev_row = prev_prev_row + n + 1;
+  double* curr_row = prev_row + n + 1;
 
   for (size_t i = 0; i <= n; ++i) {
-    prev_row[i] = i;
+    prev_row[i] = i <= k ? i : inf;
   }
+  double prev_row_min = 0;
 
   for (size_t i = 1; i <= m; ++i) {
-    curr_row[0] = i;
+    const size_t lo = i > k ? i - k : 1;
+    const size_t hi = std::min(n, i + k);
+    curr_row[0] = i <= k ? i : inf;
+    curr_row[lo - 1] = lo == 1 ? curr_row[0] : inf;
+    double row_min = curr_row[lo - 1];
 
-    for (size_t j = 1; j <= n; ++j) {
-      double cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
-      curr_row[j] =
-          std::min({prev_row[j] + 1, curr_row[j - 1] + 1, prev_row[j - 1] + qwerty_cost(a[i - 1], b[j - 1])});
+    for (size_t j = lo; j <= hi; ++j) {
+      curr_row[j] = std::min(
+          {prev_row[j] + 1, curr_row[j - 1] + 1, prev_row[j - 1] + qwerty_cost(a[i - 1], b[j - 1])});
 
       if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
         curr_row[j] = std::min(curr_row[j], prev_prev_row[j - 2] + 1);
       }
+      row_min = std::min(row_min, curr_row[j]);
     }
-    auto tmp = std::move(prev_prev_row);
-    memset(tmp.data(), 0, tmp.size());
-    prev_prev_row = std::move(prev_row);
-    prev_row = std::move(curr_row);
-    curr_row = std::move(tmp);
+    if (hi < n)
+      curr_row[hi + 1] = inf;
+    // next rows computed only from this and previous one (transposition)
+    if (row_min > max_distance && prev_row_min + 1 > max_distance)
+      return inf;
+    double* tmp = prev_prev_row;
+    prev_prev_row = prev_row;
+    prev_row = curr_row;
+    curr_row = tmp;
+    prev_row_min = row_min;
   }
 
-  return prev_row[n];
+  return prev_row[n] > max_distance ? inf : prev_row[n];
+}
+
+osa_pattern::osa_pattern(std::string_view pattern) noexcept : size(pattern.size()) {
+  if (!valid())
+    return;
+  for (std::size_t i = 0; i < size; ++i)
+    peq[to_lower(pattern[i])] |= std::uint64_t(1) << i;
+}
+
+namespace {
+
+// osa_pattern::distance for 2 strings of same size at once, one in each 64-bit lane
+#ifdef CLINOK_SSE2
+void osa_distance_sse2(const std::uint64_t* peq, std::size_t size, const std::string_view* s,
+                       std::size_t* out) noexcept {
+  const __m128i ones = _mm_set1_epi64x(-1);
+  const __m128i one = _mm_set1_epi64x(1);
+  const __m128i last = _mm_cvtsi32_si128(int(size - 1));
+  __m128i vp = ones;
+  __m128i vn = _mm_setzero_si128();
+  __m128i d0 = _mm_setzero_si128();
+  __m128i pm_prev = _mm_setzero_si128();
+  __m128i dist = _mm_set1_epi64x(std::int64_t(size));
+
+  for (std::size_t i = 0; i < s[0].size(); ++i) {
+    __m128i pm = _mm_set_epi64x(std::int64_t(peq[to_lower(s[1][i])]), std::int64_t(peq[to_lower(s[0][i])]));
+    __m128i tr = _mm_and_si128(_mm_slli_epi64(_mm_andnot_si128(d0, pm), 1), pm_prev);
+    __m128i sum = _mm_xor_si128(_mm_add_epi64(_mm_and_si128(pm, vp), vp), vp);
+    d0 = _mm_or_si128(_mm_or_si128(sum, pm), _mm_or_si128(vn, tr));
+
+    __m128i hp = _mm_or_si128(vn, _mm_andnot_si128(_mm_or_si128(d0, vp), ones));
+    __m128i hn = _mm_and_si128(d0, vp);
+    dist = _mm_add_epi64(dist, _mm_and_si128(_mm_srl_epi64(hp, last), one));
+    dist = _mm_sub_epi64(dist, _mm_and_si128(_mm_srl_epi64(hn, last), one));
+
+    hp = _mm_or_si128(_mm_slli_epi64(hp, 1), one);
+    hn = _mm_slli_epi64(hn, 1);
+    vp = _mm_or_si128(hn, _mm_andnot_si128(_mm_or_si128(d0, hp), ones));
+    vn = _mm_and_si128(hp, d0);
+    pm_prev = pm;
+  }
+  alignas(16) std::uint64_t res[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(res), dist);
+  out[0] = res[0];
+  out[1] = res[1];
+}
+#endif
+
+// same as osa_distance_sse2 for 4 strings
+#ifdef CLINOK_AVX2
+CLINOK_AVX2_TARGET void osa_distance_avx2(const std::uint64_t* peq, std::size_t size,
+                                          const std::string_view* s, std::size_t* out) noexcept {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m128i last = _mm_cvtsi32_si128(int(size - 1));
+  __m256i vp = ones;
+  __m256i vn = _mm256_setzero_si256();
+  __m256i d0 = _mm256_setzero_si256();
+  __m256i pm_prev = _mm256_setzero_si256();
+  __m256i dist = _mm256_set1_epi64x(std::int64_t(size));
+
+  for (std::size_t i = 0; i < s[0].size(); ++i) {
+    __m256i pm = _mm256_set_epi64x(
+        std::int64_t(peq[to_lower(s[3][i])]), std::int64_t(peq[to_lower(s[2][i])]),
+        std::int64_t(peq[to_lower(s[1][i])]), std::int64_t(peq[to_lower(s[0][i])]));
+    __m256i tr = _mm256_and_si256(_mm256_slli_epi64(_mm256_andnot_si256(d0, pm), 1), pm_prev);
+    __m256i sum = _mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(pm, vp), vp), vp);
+    d0 = _mm256_or_si256(_mm256_or_si256(sum, pm), _mm256_or_si256(vn, tr));
+
+    __m256i hp = _mm256_or_si256(vn, _mm256_andnot_si256(_mm256_or_si256(d0, vp), ones));
+    __m256i hn = _mm256_and_si256(d0, vp);
+    dist = _mm256_add_epi64(dist, _mm256_and_si256(_mm256_srl_epi64(hp, last), one));
+    dist = _mm256_sub_epi64(dist, _mm256_and_si256(_mm256_srl_epi64(hn, last), one));
+
+    hp = _mm256_or_si256(_mm256_slli_epi64(hp, 1), one);
+    hn = _mm256_slli_epi64(hn, 1);
+    vp = _mm256_or_si256(hn, _mm256_andnot_si256(_mm256_or_si256(d0, hp), ones));
+    vn = _mm256_and_si256(hp, d0);
+    pm_prev = pm;
+  }
+  alignas(32) std::uint64_t res[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(res), dist);
+  for (int i = 0; i < 4; ++i)
+    out[i] = res[i];
+}
+
+bool has_avx2() noexcept {
+  #ifdef CLINOK_AVX2_RUNTIME_CHECK
+  static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return supported;
+  #else
+  return true;
+  #endif
+}
+#endif
+
+}  // namespace
+
+// Hyyro 2003, "A bit-vector algorithm for computing Levenshtein and Damerau edit distances"
+std::size_t osa_pattern::distance(std::string_view s) const noexcept {
+  assert(valid());
+  if (size == 0)
+    return s.size();
+  std::uint64_t vp = ~std::uint64_t(0);
+  std::uint64_t vn = 0;
+  std::uint64_t d0 = 0;
+  std::uint64_t pm_prev = 0;
+  const std::uint64_t last = std::uint64_t(1) << (size - 1);
+  std::size_t dist = size;
+
+  for (char c : s) {
+    std::uint64_t pm = peq[to_lower(c)];
+    std::uint64_t tr = (((~d0) & pm) << 1) & pm_prev;
+    d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+
+    std::uint64_t hp = vn | ~(d0 | vp);
+    std::uint64_t hn = d0 & vp;
+    dist += bool(hp & last);
+    dist -= bool(hn & last);
+
+    hp = (hp << 1) | 1;
+    hn = hn << 1;
+    vp = hn | ~(d0 | hp);
+    vn = hp & d0;
+    pm_prev = pm;
+  }
+  return dist;
+}
+
+void osa_pattern::distance(std::span<const std::string_view> s, std::size_t* out) const noexcept {
+  assert(valid());
+  std::size_t i = 0;
+  // lanes are shifted by 'size - 1'
+  if (size != 0) {
+#ifdef CLINOK_AVX2
+    if (has_avx2()) {
+      for (; s.size() - i >= 4; i += 4)
+        osa_distance_avx2(peq, size, s.data() + i, out + i);
+    }
+#endif
+#ifdef CLINOK_SSE2
+    for (; s.size() - i >= 2; i += 2)
+      osa_distance_sse2(peq, size, s.data() + i, out + i);
+#endif
+  }
+  for (; i < s.size(); ++i)
+    out[i] = distance(s[i]);
+}
+
+suggestion_index::suggestion_index(std::vector<std::string> candidates) {
+  entries.reserve(candidates.size());
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+    entries.push_back(entry{std::move(candidates[i]), i});
+  std::ranges::stable_sort(entries, {}, [](const entry& e) { return e.str.size(); });
+  std::size_t max_len = entries.empty() ? 0 : entries.back().str.size();
+  length_begin.resize(max_len + 2);
+  auto it = entries.begin();
+  for (std::size_t l = 0; l <= max_len + 1; ++l) {
+    length_begin[l] = it - entries.begin();
+    it = std::find_if(it, entries.end(), [&](const entry& e) { return e.str.size() > l; });
+  }
+}
+
+std::size_t suggestion_index::suggest(std::string_view str, double max_diff,
+                                     std::span<suggestion> out) const {
+  if (out.empty() || entries.empty())
+    return 0;
+  std::size_t count = 0;
+  auto is_full = [&] { return count == out.size(); };
+  auto worst = [&]() -> const suggestion& { return out[count - 1]; };
+  // 'lb' is lower bound for distance to candidate with 'index'
+  auto may_be_accepted = [&](double lb, std::size_t index) {
+    return lb < max_diff && (!is_full() || std::tie(lb, index) < std::tie(worst().diff, worst().index));
+  };
+  auto try_insert = [&](const entry& e, double d) {
+    if (d >= max_diff)
+      return;
+    if (is_full() && std::tie(d, e.index) >= std::tie(worst().diff, worst().index))
+      return;
+    suggestion s{e.str, d, e.index};
+    std::size_t i = is_full() ? count - 1 : count++;
+    for (; i > 0 && std::tie(d, e.index) < std::tie(out[i - 1].diff, out[i - 1].index); --i)
+      out[i] = out[i - 1];
+    out[i] = s;
+  };
+  osa_pattern pattern(str);
+  // lower bounds for candidates of same length are computed in blocks, several at once
+  constexpr std::size_t block_size = 8;
+  std::string_view block[block_size];
+  std::size_t lower_bounds[block_size];
+  auto visit_length = [&](std::size_t l) {
+    for (std::size_t b = length_begin[l]; b < length_begin[l + 1]; b += block_size) {
+      const std::size_t n = std::min(block_size, length_begin[l + 1] - b);
+      if (pattern.valid()) {
+        for (std::size_t i = 0; i < n; ++i)
+          block[i] = entries[b + i].str;
+        pattern.distance(std::span(block, n), lower_bounds);
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        const entry& e = entries[b + i];
+        if (pattern.valid() && !may_be_accepted(lower_bounds[i] / 2.0, e.index))
+          continue;
+        double bound = is_full() ? worst().diff : max_diff;
+        try_insert(e, damerau_levenshtein_distance(str, e.str, bound));
+      }
+    }
+  };
+  // each inserted or deleted char costs 1, so length difference is lower bound for distance.
+  // Lengths closest to 'str' visited first to find good candidates early
+  const std::size_t max_len = length_begin.size() - 2;
+  for (std::size_t delta = 0; may_be_accepted(delta, 0); ++delta) {
+    bool has_shorter = delta <= str.size();
+    bool has_longer = str.size() + delta <= max_len;
+    if (!has_shorter && !has_longer)
+      break;
+    if (has_shorter && str.size() - delta <= max_len)
+      visit_length(str.size() - delta);
+    if (delta != 0 && has_longer)
+      visit_length(str.size() + delta);
+  }
+  return count;
 }
 
 std::string_view e2str(errc e) noexcept {
@@ -167,10 +477,202 @@ std::string_view e2str(errc e) noexcept {
       return "disallowed free arg";
     case errc::option_missing:
       return "option missing";
+    case errc::invalid_response_file:
+      return "invalid response file";
+    case errc::invalid_config_file:
+      return "invalid config file";
     case errc::ok:
       return "ok";
   }
   return "";
 }
 
+namespace {
+
+constexpr bool is_arg_separator(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr bool is_unquoted_special(char c) noexcept {
+  return is_arg_separator(c) || c == '\'' || c == '"' || c == '\\';
+}
+
+// first separator, quote or backslash in [b, e)
+const char* find_unquoted_special(const char* b, const char* e) noexcept {
+#ifdef CLINOK_SSE2
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i squote = _mm_set1_epi8('\'');
+  const __m128i dquote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; e - b >= 16; b += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i sep = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab)),
+                               _mm_or_si128(_mm_cmpeq_epi8(x, newline), _mm_cmpeq_epi8(x, cr)));
+    __m128i esc = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, squote), _mm_cmpeq_epi8(x, dquote)),
+                               _mm_cmpeq_epi8(x, backslash));
+    if (unsigned mask = _mm_movemask_epi8(_mm_or_si128(sep, esc)))
+      return b + std::countr_zero(mask);
+  }
+#endif
+  while (b != e && !is_unquoted_special(*b))
+    ++b;
+  return b;
+}
+
+// first " or \ in [b, e)
+const char* find_dquoted_special(const char* b, const char* e) noexcept {
+#ifdef CLINOK_SSE2
+  const __m128i dquote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; e - b >= 16; b += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(x, dquote), _mm_cmpeq_epi8(x, backslash));
+    if (unsigned mask = _mm_movemask_epi8(m))
+      return b + std::countr_zero(mask);
+  }
+#endif
+  while (b != e && *b != '"' && *b != '\\')
+    ++b;
+  return b;
+}
+
+// next argument starting at 'in' or after separators. If 'Write', argument is unescaped over itself
+// (unescaped argument is never longer then escaped), otherwise only its bounds are found.
+// Nothing is written at 'end', argument is not null-terminated
+template <bool Write>
+CLINOK_SPLIT_INLINE noexport::split_step next_arg(char*& pos, char* const end,
+                                               noexport::split_token& out) noexcept {
+  using noexport::split_step;
+  // local copy, writes of chars may alias 'pos'
+  char* in = pos;
+  for (;;) {
+    while (in != end && is_arg_separator(*in))
+      ++in;
+    if (in == end) {
+      pos = in;
+      return split_step::none;
+    }
+    char* const begin = in;
+    char* w = begin;
+    auto append = [&](const char* b, const char* e) {
+      if constexpr (Write) {
+        if (w != b)
+          std::memmove(w, b, e - b);
+      }
+      w += e - b;
+    };
+    auto put = [&](char c) {
+      if constexpr (Write)
+        *w = c;
+      ++w;
+    };
+    // "" and '' are arguments, but \<newline> alone is not
+    bool quoted = false;
+    while (in != end) {
+      const char* s = find_unquoted_special(in, end);
+      append(in, s);
+      in += s - in;
+      if (in == end || is_arg_separator(*in))
+        break;
+      if (*in == '\'') {
+        quoted = true;
+        auto* q = static_cast<const char*>(std::memchr(in + 1, '\'', end - in - 1));
+        if (!q) {
+          pos = in;
+          return split_step::unterminated_quote;
+        }
+        append(in + 1, q);
+        in += q + 1 - in;
+      } else if (*in == '"') {
+        quoted = true;
+        for (++in;;) {
+          s = find_dquoted_special(in, end);
+          append(in, s);
+          in += s - in;
+          if (in != end && *in == '"') {
+            ++in;
+            break;
+          }
+          // no closing quote or it is escaped by trailing backslash
+          if (in == end || in + 1 == end) {
+            pos = in;
+            return split_step::unterminated_quote;
+          }
+          char c = in[1];
+          if (c == '\n') {
+            in += 2;
+          } else if (c == '$' || c == '`' || c == '"' || c == '\\') {
+            put(c);
+            in += 2;
+          } else {
+            put('\\');
+            ++in;
+          }
+        }
+      } else {
+        // backslash, trailing one stays as is
+        if (in + 1 == end) {
+          put('\\');
+          ++in;
+        } else {
+          if (in[1] != '\n')
+            put(in[1]);
+          in += 2;
+        }
+      }
+    }
+    // \<newline> only
+    if (w == begin && !quoted)
+      continue;
+    out = {begin, w, in == end};
+    // separator, it may be overwritten by '\0'
+    pos = in == end ? in : in + 1;
+    return split_step::arg;
+  }
+}
+
+}  // namespace
+
+namespace noexport {
+
+split_step split_next_arg(char*& in, char* end, split_token& out) noexcept {
+  return next_arg<true>(in, end, out);
+}
+
+split_step skip_next_arg(char*& in, char* end, split_token& out) noexcept {
+  return next_arg<false>(in, end, out);
+}
+
+}  // namespace noexport
+
+split_result split_command_line(char* cmd, std::size_t size, std::span<arg> out) noexcept {
+  split_result result;
+  char* in = cmd;
+  char* const end = cmd + size;
+  for (noexport::split_token t;;) {
+    while (in != end && is_arg_separator(*in))
+      ++in;
+    if (in == end)
+      return result;
+    if (result.count == out.size()) {
+      result.what = split_errc::too_many_args;
+      return result;
+    }
+    switch (next_arg<true>(in, end, t)) {
+      case noexport::split_step::none:
+        return result;
+      case noexport::split_step::unterminated_quote:
+        result.what = split_errc::unterminated_quote;
+        return result;
+      case noexport::split_step::arg:
+        *t.end = '\0';
+        out[result.count++] = t.begin;
+        break;
+    }
+  }
+}
+
 }  // namespace clinok
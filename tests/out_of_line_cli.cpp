@@ -0,0 +1,8 @@
+// parser for program3_options.def is generated only here, test_clinok.cpp includes only declarations
+
+#include "../examples/point.hpp"
+
+#define program_options_file "../tests/program3_options.def"
+#define CLINOK_NAMESPACE_NAME cli5
+#define CLINOK_OUT_OF_LINE_DEFINITIONS
+#include <clinok/cli_interface.hpp>
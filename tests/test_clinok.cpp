@@ -1,3 +1,4 @@
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -9,6 +10,14 @@ static int calcualte_default_myint() {
 #define CLINOK_NAMESPACE_NAME cli1
 #include <clinok/cli_interface.hpp>
 
+// same options parsed by table-driven parse
+#define program_options_file "../tests/program_options.def"
+#define CLINOK_NAMESPACE_NAME cli1_table
+#include <clinok/cli_interface.hpp>
+
+template <>
+constexpr inline bool clinok::table_driven_parse<cli1_table::cli_t> = true;
+
 #define program_options_file "../tests/program2_options.def"
 #define CLINOK_NAMESPACE_NAME cli2
 
@@ -21,11 +30,62 @@ static int calcualte_default_myint() {
 
 #include <clinok/cli_interface.hpp>
 
+static std::atomic_int default_cache_dir_calls = 0;
+
+static std::string default_cache_dir() {
+  ++default_cache_dir_calls;
+  return std::string("/tmp/") + "cache";
+}
+
+#define program_options_file "../tests/program4_options.def"
+#define CLINOK_NAMESPACE_NAME cli4
+
+#include <clinok/cli_interface.hpp>
+
+// defined in out_of_line_cli.cpp
+#define program_options_file "../tests/program3_options.def"
+#define CLINOK_NAMESPACE_NAME cli5
+
+#include <clinok/cli_declarations.hpp>
+
+#include <clinok/live_options.hpp>
+#include <clinok/snapshot.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <new>
 #include <sstream>
+#include <thread>
 #include <tuple>
 #include <algorithm>
 
+// counts heap allocations to check allocation-free paths
+static std::atomic<std::size_t> allocations_count = 0;
+
+void* operator new(std::size_t size) {
+  allocations_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  allocations_count.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
 void on_error(int line) {
   std::cout << "ERROR ON LINE " << line;
   std::exit(line);
@@ -77,6 +137,9 @@ namespace clinok {
 template <>
 constexpr std::string_view placeholder_of<cli3::timeout_o> = "<seconds>";
 
+template <>
+constexpr std::size_t max_possible_values_in_error<cli3::log_level_e> = 3;
+
 }  // namespace clinok
 
 void test_trim_ws() {
@@ -90,6 +153,50 @@ void test_trim_ws() {
   static_assert(trim_ws("   abc   ") == "abc");
 }
 
+void test_perfect_hash() {
+  using clinok::noexport::make_perfect_hash_table;
+
+  constexpr auto empty = make_perfect_hash_table(std::array<std::string_view, 0>{});
+  static_assert(!empty.contains("") && !empty.contains("abc"));
+  constexpr auto t =
+      make_perfect_hash_table(std::to_array<std::string_view>({"a", "b", "ab", "ba", "", "help"}));
+  static_assert(t.find("a") == 0 && t.find("b") == 1 && t.find("ab") == 2 && t.find("ba") == 3);
+  static_assert(t.find("") == 4 && t.find("help") == 5);
+  static_assert(t.find("c") == 6 && t.find("hel") == 6 && t.find("helpp") == 6);
+  try {
+    (void)make_perfect_hash_table(std::to_array<std::string_view>({"a", "b", "a"}));
+    error_if(true);
+  } catch (const char* p) {
+    assert_eq(std::string_view("duplicate names"), p);
+  }
+
+  static_assert(clinok::options_count<cli1::cli_t>() == 9);
+  static_assert(clinok::find_option<cli1::cli_t>("mytag") == 0);
+  static_assert(clinok::find_option<cli1::cli_t>("help") == 8);
+  static_assert(clinok::find_option<cli1::cli_t>("h") == 9);
+  static_assert(clinok::find_option<cli3::cli_t>("log-level") == 0);
+  static_assert(clinok::find_option<cli3::cli_t>("log_level") == 5);
+  std::string_view visited;
+  error_if(!clinok::visit_option_by_index<cli3::cli_t>(
+      1, [&]<typename O>(O) { visited = clinok::name_of<O>; }));
+  assert_eq(std::string_view("timeout"), visited);
+  error_if(clinok::visit_option_by_index<cli3::cli_t>(5, [](auto) {}));
+
+  using color_names = cli1::color_e_enum_description;
+  static_assert(color_names::names_table.find("red") == 0 && color_names::names_table.find("yellow") == 3);
+  static_assert(color_names::names_table.find("purple") == 4 && color_names::names_table.find("") == 4);
+  // big tables are built without exceeding constexpr evaluation limits
+  constexpr auto big = [] {
+    std::string_view chars = "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789"
+                             "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::array<std::string_view, 2000> names;
+    for (std::size_t i = 0; i < names.size(); ++i)
+      names[i] = chars.substr(i % 36, 1 + i / 36);
+    return make_perfect_hash_table(names);
+  }();
+  static_assert(big.find("a") == 0 && big.find("9abcd") == 35 + 4 * 36 && big.find("-") == 2000);
+}
+
 void test_split_by_comma() {
   using clinok::noexport::split_str_by_comma;
 
@@ -160,6 +267,103 @@ void test_levenshtein_distance() {
   error_if(d1 != 0.5 || d2 != 2);  // 'p' closer to 'o' then to 'a' on qwerty keyboard
 }
 
+void test_bounded_distance() {
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  std::string_view words[] = {"",      "a",       "--help",   "--hlep",      "--myint",  "--myint2", "-hh",
+                              "Works", "qwerty",  "ytrewq",   "kitten",      "sitting",  "--ABC2",   "abcd",
+                              "badc",  "--works", "--colour", "--hello_world"};
+  for (std::string_view a : words) {
+    for (std::string_view b : words) {
+      double d = clinok::damerau_levenshtein_distance(a, b);
+      for (double max : {0.0, 0.5, 1.0, 1.5, 2.0, 3.0, 4.5, 7.0, 100.0, inf}) {
+        double bounded = clinok::damerau_levenshtein_distance(a, b, max);
+        error_if(d <= max ? bounded != d : bounded != inf);
+      }
+    }
+  }
+  // long argument does not stall search
+  std::string blob(1 << 24, 'x');
+  error_if(clinok::damerau_levenshtein_distance(blob, "--help", 5) != inf);
+  blob.replace(0, 6, "--help");
+  std::string_view blob_prefix = std::string_view(blob).substr(0, 1 << 16);
+  error_if(clinok::damerau_levenshtein_distance(blob_prefix, blob_prefix, 1) != 0);
+  auto [str, diff] = clinok::best_match_str(blob, std::to_array<std::string_view>({"--help", "--myint"}), 5);
+  error_if(!str.empty() || diff != std::numeric_limits<double>::max());
+  auto res = clinok::best_match_str("--hepl", std::to_array<std::string_view>({"--myint", "--help"}), 5);
+  error_if(res.found != "--help" || res.diff != 1);
+}
+
+void test_osa_distance() {
+  struct testcase {
+    std::string a;
+    std::string b;
+    std::size_t expected;
+  };
+  // clang-format off
+  testcase tests[] = {
+      {"", "", 0},
+      {"", "abc", 3},
+      {"abc", "", 3},
+      {"cat", "cat", 0},
+      {"cat", "CaT", 0},
+      {"kitten", "sitting", 3},
+      {"ca", "abc", 3},
+      {"abcd", "bacd", 1},
+      {"abcd", "badc", 2},
+      {"hello", "hlelo", 1},
+      {"book", "back", 2},
+  };
+  // clang-format on
+  for (const auto& test : tests) {
+    clinok::osa_pattern p(test.a);
+    error_if(!p.valid());
+    error_if(p.distance(test.b) != test.expected);
+  }
+  error_if(clinok::osa_pattern(std::string(65, 'a')).valid());
+  // lower bound for weighted distance
+  std::string_view words[] = {"--help", "--myint", "-hh", "--hello_world", "Works", "qwerty", "--ABC2", ""};
+  for (std::string_view a : words) {
+    clinok::osa_pattern p(a);
+    for (std::string_view b : words)
+      error_if(p.distance(b) / 2.0 > clinok::damerau_levenshtein_distance(a, b));
+  }
+  // several strings of same size at once, 7 uses all lane counts
+  std::string_view same_size[] = {"--help", "--hepl", "--HELP", "qwerty", "------", "--myin", "helpxx"};
+  for (std::string_view a : {"--help", "", "--help_me_please", "a"}) {
+    clinok::osa_pattern p(a);
+    std::size_t out[std::size(same_size)];
+    p.distance(same_size, out);
+    for (std::size_t i = 0; i < std::size(same_size); ++i)
+      error_if(out[i] != p.distance(same_size[i]));
+  }
+}
+
+void test_suggestion_index() {
+  std::vector<std::string> names = {"--help", "--myint", "--myint2", "-hh", "--hello_world", "-w",
+                                    "--works", "--color", "-c",       "",    "--ABC2"};
+  clinok::suggestion_index index(names);
+  std::string_view typed[] = {"--a", "--hlep", "--myint3", "-h", "", "--colour", "--works", "qwertyuiop"};
+  for (std::string_view t : typed) {
+    clinok::suggestion s[3];
+    std::size_t count = index.suggest(t, std::numeric_limits<double>::max(), s);
+    error_if(count != 3);
+    auto expected = clinok::best_match_str(t, names);
+    assert_eq(expected.found, s[0].str);
+    error_if(expected.diff != s[0].diff || names[s[0].index] != s[0].str);
+    error_if(s[0].diff > s[1].diff || s[1].diff > s[2].diff);
+  }
+  clinok::suggestion s[2];
+  error_if(index.suggest("--myint", 0.5, s) != 1 || s[0].str != "--myint");
+  error_if(index.suggest("--myint", 1.5, s) != 2 || s[1].str != "--myint2");
+  error_if(index.suggest("--hlep", 0.5, s) != 0);
+  error_if(clinok::suggestion_index{}.suggest("--hlep", 10, s) != 0);
+
+  clinok::suggestion best[2];
+  error_if(clinok::suggest<cli1::cli_t>("--myin", best) != 2);
+  assert_eq(std::string_view("--myint"), best[0].str);
+  assert_eq(std::string_view("--myint2"), best[1].str);
+}
+
 void test_parse1(std::vector<const char*> argv, clinok::errc expected_err, std::string expected_msg) {
   clinok::error_code ec;
   cli1::options o = cli1::parse(clinok::args_range(argv.size(), (char**)argv.data()), ec);
@@ -220,6 +424,770 @@ void test_parse3_value(std::vector<const char*> argv, cli3::options expected) {
   error_if(o != expected);
 }
 
+void test_parse_batch() {
+  std::vector<std::vector<const char*>> argvs = {
+      {"program_name_placeholder", "--myint2", "1", "--color", "red"},
+      {"program_name_placeholder", "--myint2", "2", "-c", "blue", "-hh", "5"},
+      {"program_name_placeholder", "--myint2"},
+      {"program_name_placeholder", "--mynt2", "3"},
+  };
+  // more then one chunk per thread
+  std::vector<clinok::args_t> args;
+  for (std::size_t i = 0; i < 2000; ++i)
+    args.push_back(clinok::args_range(argvs[i % argvs.size()].size(), argvs[i % argvs.size()].data()));
+  for (unsigned threads_count : {0u, 1u, 3u}) {
+    std::vector<cli1::options> opts(args.size());
+    std::vector<cli1::cli_t::presented_options> presented(args.size());
+    std::vector<clinok::error_code> errs(args.size());
+    clinok::parse_batch<cli1::cli_t>(args, opts, presented, errs, threads_count);
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      clinok::error_code ec;
+      cli1::cli_t::presented_options p;
+      cli1::options o = clinok::parse<cli1::cli_t>(args[i], p, ec);
+      error_if(ec.what != errs[i].what || ec.ctx.typed != errs[i].ctx.typed);
+      error_if(!ec && o != opts[i]);
+      error_if(p != presented[i]);
+    }
+  }
+  // empty batch starts no threads
+  for (unsigned threads_count : {0u, 1u, 3u})
+    clinok::parse_batch<cli1::cli_t>({}, std::span<cli1::options>(), std::span<clinok::error_code>(),
+                                     threads_count);
+}
+
+void test_default_options_image() {
+  // defaults of builtin types are parsed at compile time, Point parsed once on first use
+  static_assert(clinok::noexport::constexpr_default_options<cli1::cli_t>);
+  static_assert(!clinok::noexport::constexpr_default_options<cli3::cli_t>);
+  static_assert(clinok::default_value_for<cli3::timeout_o>() == 10);
+  static_assert(clinok::default_value_for<cli3::log_level_o>() == cli3::log_level_e::trace);
+
+  cli1::options d1 = clinok::default_options<cli1::cli_t>();
+  error_if(d1.hello_world != "hello, man" || d1.ABC2 != "why" || d1.works || d1.myint != 17);
+  cli3::options d3 = clinok::default_options<cli3::cli_t>();
+  error_if(d3.timeout != 10 || d3.location != Point{} || d3.log_level != cli3::log_level_e::trace);
+
+  std::vector<const char*> argv = {"program_name_placeholder", "--myint2", "-5", "--ABC2", "x",
+                                   "--color", "red"};
+  for (int i = 0; i < 2; ++i) {
+    clinok::error_code ec;
+    cli1::options o = cli1::parse(clinok::args_range(argv.size(), argv.data()), ec);
+    error_if(ec);
+    error_if(o.myint2 != -5 || o.ABC2 != "x" || o.hello_world != "hello, man" || o.myint != 17);
+  }
+  // image is not changed by parse
+  error_if(clinok::default_options<cli1::cli_t>() != d1);
+}
+
+void test_presented_options() {
+  // bit per option and counter for myint
+  static_assert(sizeof(cli1::cli_t::presented_options) <= 16);
+  std::vector<const char*> argv = {"program_name_placeholder", "--myint2", "1", "-hh", "5", "--color", "red",
+                                   "--myint", "6"};
+  cli1::cli_t::presented_options p;
+  clinok::error_code ec;
+  cli1::options o = clinok::parse<cli1::cli_t>(clinok::args_range(argv.size(), argv.data()), p, ec);
+  error_if(ec || o.myint != 6);
+  error_if(p.myint != 2 || p.bits.count() != 3);
+  error_if(!clinok::is_presented<cli1::cli_t>(p, "myint2") || !clinok::is_presented<cli1::cli_t>(p, "color"));
+  error_if(clinok::is_presented<cli1::cli_t>(p, "works") || clinok::is_presented<cli1::cli_t>(p, "hh"));
+
+  // counter saturates
+  argv.resize(1);
+  for (int i = 0; i < 300; ++i)
+    argv.insert(argv.end(), {"-hh", "1"});
+  o = clinok::parse<cli1::cli_t>(clinok::args_range(argv.size(), argv.data()), p, ec);
+  error_if(p.myint != 255);
+  error_if(ec.what != clinok::errc::required_option_not_present);
+}
+
+void test_pull_parser() {
+  std::vector<const char*> argv = {"program_name_placeholder", "--location", "1", "2", "-t", "5",
+                                   "--user", "u", "-l", "info"};
+  std::vector<std::string> events;
+  {
+    clinok::pull_parser<cli3::cli_t> parser(clinok::args_range(argv.size(), argv.data()));
+    clinok::parse_event e;
+    while (parser.next(e)) {
+      std::stringstream str;
+      str << e.typed << ' ' << e.name << ' ' << e.values.size() << ' ';
+      bool visited = clinok::visit_event<cli3::cli_t>(e, [&]<typename O>(O, const auto& value) {
+        if constexpr (std::is_same_v<O, cli3::log_level_o>)
+          str << e2str(value);
+        else
+          str << value;
+      });
+      error_if(visited == e.is_free_arg());
+      events.push_back(str.str());
+    }
+    error_if(parser.error());
+  }
+  std::vector<std::string> expected = {"--location location 2 1 2", "-t timeout 1 5", "--user user 1 u",
+                                       "-l log-level 1 info"};
+  error_if(events != expected);
+
+  {
+    std::vector<const char*> argv2 = {"program_name_placeholder", "free", "--works", "on"};
+    clinok::pull_parser<cli2::cli_t> parser(clinok::args_range(argv2.size(), argv2.data()));
+    clinok::parse_event e;
+    error_if(!parser.next(e) || !e.is_free_arg() || e.typed != "free" || e.values.size() != 1);
+    error_if(!parser.next(e) || e.is_free_arg() || *static_cast<const bool*>(e.value) != true);
+    error_if(parser.next(e) || parser.error());
+  }
+
+  // consumer may stop early, error stops parsing
+  argv = {"program_name_placeholder", "--timeout", "5", "--timeout", "x", "--user", "u"};
+  clinok::pull_parser<cli3::cli_t> parser(clinok::args_range(argv.size(), argv.data()));
+  clinok::parse_event e;
+  error_if(!parser.next(e) || e.option_index != clinok::find_option<cli3::cli_t>("timeout"));
+  error_if(parser.next(e) || parser.next(e));
+  error_if(parser.error().what != clinok::errc::not_a_number);
+  assert_eq(std::string_view("x"), parser.error().ctx.value);
+}
+
+void test_parse_into() {
+  std::vector<std::vector<const char*>> argvs = {
+      {"program_name_placeholder", "a", "--myname", "x", "b", "c"},
+      {"program_name_placeholder", "--works", "on", "--ABC2", "y"},
+      {"program_name_placeholder", "--works", "on", "--ABC2"},
+      {"program_name_placeholder", "d", "--mytag", "--myname", "z"},
+  };
+  std::vector<clinok::args_t> args;
+  std::vector<cli2::options> expected(argvs.size());
+  std::vector<cli2::cli_t::presented_options> expected_presented(argvs.size());
+  std::vector<clinok::error_code> expected_errs(argvs.size());
+  for (std::size_t i = 0; i < argvs.size(); ++i) {
+    args.push_back(clinok::args_range(argvs[i].size(), argvs[i].data()));
+    expected[i] = clinok::parse<cli2::cli_t>(args[i], expected_presented[i], expected_errs[i]);
+  }
+  cli2::options opts = clinok::default_options<cli2::cli_t>();
+  cli2::cli_t::presented_options presented;
+  clinok::error_code ec;
+  std::size_t before = allocations_count;
+  for (std::size_t i = 0; i < 2 * args.size(); ++i) {
+    if (i == args.size())  // vector of additional args has enough capacity after first round
+      before = allocations_count;
+    std::size_t j = i % args.size();
+    clinok::parse_into<cli2::cli_t>(opts, presented, args[j], ec);
+    error_if(ec.what != expected_errs[j].what || presented != expected_presented[j]);
+    error_if(!ec && opts != expected[j]);
+  }
+  error_if(allocations_count != before);
+
+  // std::string option keeps capacity, value is longer than small string buffer
+  std::string long_value(100, 'x');
+  // cache_dir is presented, so its default is not evaluated before test_cached_default_value
+  std::vector<const char*> argv = {"ninja", "-o", long_value.c_str(), "--output", long_value.c_str(),
+                                   "--cache_dir", "c"};
+  cli4::cli_t::presented_options p4;
+  cli4::options o4 = clinok::parse<cli4::cli_t>(clinok::args_range(argv.size(), argv.data()), p4, ec);
+  for (int i = 0; i < 3; ++i) {
+    if (i == 1)
+      before = allocations_count;
+    clinok::parse_into<cli4::cli_t>(o4, p4, clinok::args_range(argv.size(), argv.data()), ec);
+    error_if(ec || o4.output != long_value);
+  }
+  error_if(allocations_count != before);
+}
+
+static std::string write_temp_file(std::string_view name, std::string_view content) {
+  std::string path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream(path, std::ios::binary) << content;
+  return path;
+}
+
+void test_response_files() {
+  std::string_view content = " --myname\t\"my name\" \n'a\\\"b' c\\ d \"\" e\"f\"g last";
+  std::vector<std::string_view> expected = {"--myname", "my name", "a\\\"b", "c d", "", "efg", "last"};
+  std::string path = write_temp_file("clinok_test_response_file", content);
+  std::string at_path = "@" + path;
+  std::vector<const char*> argv = {"program_name_placeholder", "first", at_path.c_str(), "--works", "on"};
+
+  clinok::response_files rf;
+  clinok::arg failed = nullptr;
+  error_if(!clinok::expand_response_files(clinok::args_range(argv.size(), argv.data()), rf, failed));
+  std::vector<std::string_view> args(rf.args().begin(), rf.args().end());
+  error_if(args.size() != expected.size() + 4);
+  error_if(args[0] != "program_name_placeholder" || args[1] != "first" || args[args.size() - 2] != "--works");
+  error_if(!std::equal(expected.begin(), expected.end(), args.begin() + 2));
+
+  for (std::size_t chunk_size : {1, 3, 64 * 1024}) {
+    clinok::response_file_reader reader(path.c_str(), chunk_size);
+    error_if(!reader.is_open());
+    std::vector<std::string> read;
+    for (std::string_view a; reader.next(a);)
+      read.emplace_back(a);
+    error_if(reader.failed() || !std::equal(read.begin(), read.end(), expected.begin(), expected.end()));
+  }
+  error_if(clinok::response_file_reader("clinok_file_which_does_not_exist").is_open());
+
+  // same rules as split_command_line, unterminated quote is an error
+  std::string bad_path = write_temp_file("clinok_test_bad_response_file", "a \"b\\\" c\n");
+  std::string at_bad_path = "@" + bad_path;
+  std::vector<const char*> bad_argv = {"program_name_placeholder", at_bad_path.c_str()};
+  error_if(clinok::expand_response_files(clinok::args_range(2, bad_argv.data()), rf, failed) ||
+           failed != at_bad_path.c_str());
+  for (std::size_t chunk_size : {1, 64 * 1024}) {
+    clinok::response_file_reader reader(bad_path.c_str(), chunk_size);
+    std::string_view a;
+    error_if(!reader.next(a) || a != "a" || reader.next(a) || !reader.failed());
+  }
+  std::filesystem::remove(bad_path);
+
+  {
+    cli2::options expected_opts = clinok::default_options<cli2::cli_t>();
+    expected_opts.myname = "my name";
+    expected_opts.works = true;
+    expected_opts.additional_args = {"first", "a\\\"b", "c d", "", "efg", "last"};
+    clinok::error_code ec;
+    cli2::options o = cli2::parse(clinok::args_range(argv.size(), argv.data()), ec);
+    error_if(ec);
+    error_if(o != expected_opts);
+    cli2::options copy = o;
+    o = {};
+    // copy keeps file mapping
+    error_if(copy != expected_opts);
+  }
+  std::filesystem::remove(path);
+
+  // empty file
+  path = write_temp_file("clinok_test_empty_response_file", "");
+  at_path = "@" + path;
+  argv = {"program_name_placeholder", at_path.c_str()};
+  error_if(!clinok::expand_response_files(clinok::args_range(argv.size(), argv.data()), rf, failed));
+  error_if(rf.args().size() != 1);
+  std::filesystem::remove(path);
+
+  test_parse2({"program_name_placeholder", "@clinok_file_which_does_not_exist"},
+              clinok::errc::invalid_response_file,
+              "invalid response file \"@clinok_file_which_does_not_exist\"\n");
+}
+
+void test_split_command_line() {
+  auto check = [](std::string cmd, std::vector<std::string_view> expected,
+                  clinok::split_errc what = clinok::split_errc::ok) {
+    std::vector<clinok::arg> out(cmd.size() / 2 + 1);
+    std::size_t before = allocations_count;
+    clinok::split_result r = clinok::split_command_line(cmd.data(), cmd.size(), out);
+    error_if(allocations_count != before);
+    error_if(r.what != what);
+    if (!r)
+      return;
+    error_if(r.count != expected.size());
+    for (std::size_t i = 0; i < r.count; ++i) {
+      error_if(std::string_view(out[i]) != expected[i]);
+      error_if(out[i] < cmd.data() || out[i] > cmd.data() + cmd.size());
+    }
+  };
+  check("", {});
+  check(" \t\n ", {});
+  check("a", {"a"});
+  check("  --myname\t\"my name\" \n", {"--myname", "my name"});
+  check(R"('a\"b' c\ d "" '' e"f"g)", {R"(a\"b)", "c d", "", "", "efg"});
+  check(R"("\$\`\"\\\a" \a\\ 'x'\''y')", {R"($`"\\a)", R"(a\)", "x'y"});
+  check("a\\\nb \\\n c", {"ab", "c"});
+  // CRLF line ends, e.g. response files written on Windows
+  check("a\r\nb\r\n", {"a", "b"});
+  check("\"a\\\nb\" trailing\\", {"ab", "trailing\\"});
+  // longer then SIMD block
+  check("0123456789abcdefghijklmnopqrstuvwxyz \"0123456789abcdefghij\\\"klmnopqrstuvwxyz\" 0123456789abcdef",
+        {"0123456789abcdefghijklmnopqrstuvwxyz", "0123456789abcdefghij\"klmnopqrstuvwxyz",
+         "0123456789abcdef"});
+  check("a 'b", {}, clinok::split_errc::unterminated_quote);
+  check("a \"b\\\"", {}, clinok::split_errc::unterminated_quote);
+
+  std::string cmd = "--myname  \"x y\" --mytag a b c";
+  clinok::arg argv[8] = {"program_name_placeholder"};
+  clinok::split_result r = clinok::split_command_line(cmd.data(), cmd.size(), std::span(argv + 1, 3));
+  error_if(r.what != clinok::split_errc::too_many_args || r.count != 3);
+  cmd = "--myname  \"x y\" --mytag a b c";
+  r = clinok::split_command_line(cmd.data(), cmd.size(), std::span(argv + 1, 7));
+  error_if(!r || r.count != 6);
+  clinok::error_code ec;
+  cli2::options o = cli2::parse(clinok::args_t(argv, r.count + 1), ec);
+  error_if(ec || o.myname != "x y" || !o.mytag);
+  error_if(o.additional_args != std::vector<std::string_view>{"a", "b", "c"});
+}
+
+void test_free_args_view() {
+  using strs = std::vector<std::string_view>;
+  // contiguous
+  {
+    const char* argv[] = {"ninja", "-C", "build", "-j", "8", "a", "b", "c"};
+    clinok::error_code ec;
+    std::size_t before = allocations_count;
+    cli4::options o = cli4::parse(clinok::args_range(8, argv), ec);
+    error_if(allocations_count != before);
+    error_if(ec || o.dir != "build" || o.jobs != 8);
+    error_if(!o.additional_args.contiguous() || o.additional_args.size() != 3);
+    error_if(o.additional_args.as_args().data() != argv + 5);
+    error_if(o.additional_args.to_vector() != strs{"a", "b", "c"});
+  }
+  // interleaved with options
+  {
+    const char* argv[] = {"ninja", "a", "b", "-v", "c", "-j", "8", "d", "e"};
+    clinok::error_code ec;
+    cli4::cli_t::presented_options presented;
+    cli4::options o = clinok::parse<cli4::cli_t>(clinok::args_range(9, argv), presented, ec);
+    error_if(ec || !o.verbose || o.jobs != 8);
+    const clinok::free_args_view& v = o.additional_args;
+    error_if(v.contiguous() || v.runs_count() != 3 || v.size() != 5);
+    error_if(v.to_vector() != strs{"a", "b", "c", "d", "e"});
+    error_if(v[0] != "a" || v[2] != "c" || v[4] != "e");
+    error_if(!std::equal(v.begin(), v.end(), std::next(v.begin(), 0)));
+    error_if(std::distance(v.begin(), v.end()) != 5);
+    cli4::options copy = o;
+    error_if(copy.additional_args != v);
+
+    // parse_into reuses runs storage
+    const char* argv2[] = {"ninja", "x", "-v", "y", "-C", "dir", "z"};
+    std::size_t before = allocations_count;
+    clinok::parse_into<cli4::cli_t>(o, presented, clinok::args_range(7, argv2), ec);
+    error_if(allocations_count != before);
+    error_if(ec || o.dir != "dir" || o.jobs != 1 || o.additional_args.to_vector() != strs{"x", "y", "z"});
+  }
+  // no free args
+  {
+    const char* argv[] = {"ninja", "-v"};
+    clinok::error_code ec;
+    cli4::options o = cli4::parse(clinok::args_range(2, argv), ec);
+    error_if(ec || !o.additional_args.empty() || o.additional_args.begin() != o.additional_args.end());
+    error_if(!o.additional_args.contiguous() || !o.additional_args.as_args().empty());
+  }
+}
+
+void test_cached_default_value() {
+  static_assert(clinok::caches_default_value<cli4::cache_dir_o>);
+  static_assert(!clinok::caches_default_value<cli1::myint_o>);
+  error_if(default_cache_dir_calls != 0);
+  clinok::warm_up_default_values<cli4::cli_t>();
+  error_if(default_cache_dir_calls != 1);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([] {
+      for (int j = 0; j < 100; ++j) {
+        const char* argv[] = {"ninja", "a"};
+        clinok::error_code ec;
+        cli4::options o = cli4::parse(clinok::args_range(2, argv), ec);
+        error_if(ec || o.cache_dir != "/tmp/cache");
+        error_if(clinok::default_options<cli4::cli_t>().cache_dir != "/tmp/cache");
+      }
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+  error_if(default_cache_dir_calls != 1);
+  // help prints cached value
+  std::stringstream help;
+  cli4::print_help_message_to([&](auto x) { help << x; });
+  error_if(help.str().find("/tmp/cache") == help.str().npos || default_cache_dir_calls != 1);
+  // not cached if presented
+  const char* argv[] = {"ninja", "--cache_dir", "x"};
+  clinok::error_code ec;
+  error_if(cli4::parse(clinok::args_range(3, argv), ec).cache_dir != "x" || ec);
+}
+
+void test_parse_layered() {
+  using clinok::option_source;
+  std::string path = write_temp_file("clinok_test_config",
+                                     "# comment\n"
+                                     "timeout = 5\r\n"
+                                     "  location=1 2\n"
+                                     "\n"
+                                     "user = \"config user\"\n"
+                                     "[other]\n"
+                                     "user = other\n"
+                                     "[ app ]\n"
+                                     "; comment\n"
+                                     "log-level = debug");
+  clinok::config_file config;
+  error_if(!config.open(path.c_str(), "app"));
+  error_if(config.entries().size() != 4 || config.entries()[3].key != "log-level");
+  error_if(config.entries()[1].values.size() != 2 || config.entries()[3].line != 10);
+  const char* env[] = {"APP_LOG_LEVEL=info", "PATH=/bin",     "APP_TIMEOUT=20",
+                       "APP_UNKNOWN=1",      "APP_=", nullptr};
+  const char* argv[] = {"program", "--timeout", "30"};
+
+  clinok::error_code ec;
+  cli3::cli_t::presented_options presented;
+  clinok::option_sources<cli3::cli_t> sources;
+  auto parse = [&](clinok::layered_sources src) {
+    std::size_t before = allocations_count;
+    cli3::options o = clinok::parse_layered<cli3::cli_t>(src, presented, sources, ec);
+    error_if(allocations_count != before);
+    return o;
+  };
+  cli3::options o =
+      parse({.args = clinok::args_range(3, argv), .env = env, .env_prefix = "APP_", .config = &config});
+  error_if(ec);
+  error_if(o.timeout != 30 || o.log_level != cli3::log_level_e::info || o.user != "config user");
+  error_if(o.location != Point{1, 2});
+  error_if(sources.of("timeout") != option_source::command_line);
+  error_if(sources.of("log-level") != option_source::environment);
+  error_if(sources.of("user") != option_source::config_file);
+  error_if(sources.of("location") != option_source::config_file);
+  error_if(sources.of("help") != option_source::none);
+  error_if(!clinok::is_presented<cli3::cli_t>(presented, "user"));
+
+  o = parse({.args = clinok::args_range(1, argv), .env = env, .env_prefix = "APP_", .config = &config});
+  error_if(ec || o.timeout != 20 || sources.of("timeout") != option_source::environment);
+  o = parse({.args = clinok::args_range(1, argv), .config = &config});
+  error_if(ec || o.timeout != 5 || o.log_level != cli3::log_level_e::debug);
+  o = parse({.args = clinok::args_range(1, argv), .env = env, .env_prefix = "APP_"});
+  error_if(ec.what != clinok::errc::required_option_not_present);
+
+  const char* bad_env[] = {"APP_TIMEOUT=abc", nullptr};
+  o = parse({.args = clinok::args_range(1, argv), .env = bad_env, .env_prefix = "APP_", .config = &config});
+  error_if(ec.what != clinok::errc::not_a_number || ec.ctx.typed != "APP_TIMEOUT" || ec.ctx.value != "abc");
+
+  // value without newline at end of file, unknown key
+  path = write_temp_file("clinok_test_config", "user = last\nnot_an_option = 1");
+  error_if(!config.open(path.c_str()) || config.entries()[0].values[0] != std::string_view("last"));
+  o = parse({.args = clinok::args_range(1, argv), .config = &config});
+  error_if(ec.what != clinok::errc::unknown_option || ec.ctx.typed != "not_an_option");
+  path = write_temp_file("clinok_test_config", "user = a\n\nno value\n");
+  error_if(config.open(path.c_str()) || config.failed_line() != 3);
+  path = write_temp_file("clinok_test_config", "user = \"a\n");
+  error_if(config.open(path.c_str()) || config.failed_line() != 1);
+  error_if(config.open("clinok_not_existing_config") || config.failed_line() != 0);
+  std::filesystem::remove(path);
+}
+
+void test_live_options() {
+  std::string path = write_temp_file("clinok_test_live_config", "user = first\ntimeout = 1\n");
+  const char* argv[] = {"program", "-l", "warn"};
+  clinok::live_options<cli3::cli_t> live({.args = clinok::args_range(3, argv)}, path);
+  error_if(live.read()->options.user != "" || live.reloads_count() != 0);
+  clinok::error_code ec;
+  error_if(!live.reload(ec) || ec);
+  {
+    auto r = live.read();
+    error_if(r->options.user != "first" || r->options.timeout != 1);
+    error_if(r->options.log_level != cli3::log_level_e::warn);
+    error_if(r->sources.of("log-level") != clinok::option_source::command_line);
+  }
+  // failed parse keeps previous snapshot
+  write_temp_file("clinok_test_live_config", "user = second\ntimeout = abc\n");
+  error_if(live.reload(ec) || ec.what != clinok::errc::not_a_number || !ec.owns_context());
+  error_if(live.last_error().what != clinok::errc::not_a_number);
+  error_if(live.read()->options.user != "first" || live.reloads_count() != 1);
+  write_temp_file("clinok_test_live_config", "no value\n");
+  error_if(live.reload(ec) || ec.what != clinok::errc::invalid_config_file);
+  error_if(live.read()->options.user != "first");
+
+  // readers run concurrently with reloads and always see consistent snapshot
+  std::atomic_bool stop = false;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; ++i) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        auto r = live.read();
+        std::string expected = r->options.timeout == 1 ? "first" : "u" + std::to_string(r->options.timeout);
+        error_if(r->options.user != expected);
+      }
+    });
+  }
+  for (int i = 2; i < 50; ++i) {
+    write_temp_file("clinok_test_live_config",
+                    "user = u" + std::to_string(i) + "\ntimeout = " + std::to_string(i));
+    error_if(!live.reload(ec));
+  }
+  stop = true;
+  for (auto& t : readers)
+    t.join();
+  error_if(live.read()->options.timeout != 49 || live.read()->options.user != "u49");
+
+  // watcher reloads after file changed
+  live.watch(path);
+  std::size_t reloads = live.reloads_count();
+  // watcher may start after write, so file is rewritten until change noticed
+  for (int i = 0; i < 500 && live.reloads_count() == reloads; ++i) {
+    write_temp_file("clinok_test_live_config", "user = watched\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  error_if(live.reloads_count() == reloads || live.read()->options.user != "watched");
+  std::filesystem::remove(path);
+}
+
+// offset of option 'name' value in snapshot of 'o'
+template <typename CLI>
+std::size_t snapshot_value_offset(const typename CLI::options& o, std::string_view name) {
+  std::size_t offset =
+      sizeof(clinok::noexport::snapshot_header) + clinok::noexport::presented_snapshot_size<CLI>();
+  bool found = false;
+  clinok::for_each_option<CLI>([&]<typename O>(O) {
+    if (found || (found = clinok::name_of<O> == name))
+      return;
+    if constexpr (clinok::noexport::snapshot_string<clinok::cpp_type_t<O>>)
+      offset += sizeof(std::uint64_t) + std::string_view(O::get(o)).size();
+    else
+      offset += sizeof(clinok::cpp_type_t<O>);
+  });
+  return offset;
+}
+
+void test_snapshot() {
+  using clinok::snapshot_errc;
+  static_assert(clinok::snapshot_schema_hash<cli1::cli_t> != clinok::snapshot_schema_hash<cli2::cli_t>);
+  // cli4 uses free_args_view, which is rejected by static_assert
+  static_assert(clinok::noexport::snapshot_free_args_view<cli4::cli_t> &&
+                !clinok::noexport::snapshot_free_args_view<cli2::cli_t>);
+  std::string free_arg = "free arg";
+  const char* argv[] = {"program", "--hello_world", "abc", "--mytag", free_arg.c_str(),
+                        "--works", "true",          "x",   "--myname", ""};
+  clinok::error_code ec;
+  cli2::cli_t::presented_options presented;
+  cli2::options o = clinok::parse<cli2::cli_t>(clinok::args_range(10, argv), presented, ec);
+  error_if(ec);
+  std::vector<char> snapshot = clinok::save_snapshot<cli2::cli_t>(o, presented);
+  error_if(snapshot.size() != clinok::snapshot_size<cli2::cli_t>(o));
+  // arguments may be destroyed after saving
+  free_arg = "changed";
+
+  cli2::options restored;
+  cli2::cli_t::presented_options restored_presented;
+  error_if(clinok::restore_snapshot<cli2::cli_t>(snapshot, restored, restored_presented) !=
+           snapshot_errc::ok);
+  error_if(restored_presented != presented || !restored.mytag || !restored.works);
+  error_if(restored.hello_world != "abc" || restored.ABC2 != "why" || restored.myname != "");
+  error_if(restored.additional_args != std::vector<std::string_view>{"free arg", "x"});
+  // strings point into snapshot
+  error_if(restored.hello_world.data() < snapshot.data() ||
+           restored.hello_world.data() >= snapshot.data() + snapshot.size());
+
+  std::size_t written;
+  std::vector<char> small(snapshot.size() - 1);
+  error_if(clinok::save_snapshot<cli2::cli_t>(o, presented, small, written) != snapshot_errc::too_small);
+  error_if(written != snapshot.size());
+  for (std::size_t size : {std::size_t(0), std::size_t(10), snapshot.size() - 1}) {
+    error_if(clinok::restore_snapshot<cli2::cli_t>(std::span(snapshot).first(size), restored,
+                                                   restored_presented) != snapshot_errc::not_a_snapshot);
+  }
+  cli1::options o1;
+  cli1::cli_t::presented_options p1;
+  error_if(clinok::restore_snapshot<cli1::cli_t>(snapshot, o1, p1) != snapshot_errc::schema_mismatch);
+  std::vector<char> changed = snapshot;
+  changed[4] ^= 1;
+  error_if(clinok::restore_snapshot<cli2::cli_t>(changed, restored, restored_presented) !=
+           snapshot_errc::version_mismatch);
+
+  // enum, integers and occurrence counters, restored from file mapping as worker would do
+  const char* argv1[] = {"program", "--myint", "5", "-hh", "6", "--myint2", "1", "-c", "blue"};
+  o1 = clinok::parse<cli1::cli_t>(clinok::args_range(9, argv1), p1, ec);
+  error_if(ec || p1.myint != 2);
+  snapshot = clinok::save_snapshot<cli1::cli_t>(o1, p1);
+  std::string path =
+      write_temp_file("clinok_test_snapshot", std::string_view(snapshot.data(), snapshot.size()));
+  clinok::mapped_file file;
+  error_if(!file.open(path.c_str()));
+  cli1::options r1;
+  cli1::cli_t::presented_options rp1;
+  error_if(clinok::restore_snapshot<cli1::cli_t>(std::span(file.data(), file.size()), r1, rp1) !=
+           snapshot_errc::ok);
+  error_if(rp1 != p1 || rp1.myint != 2 || r1.myint != 6 || r1.myint2 != 1);
+  error_if(r1.color != cli1::color_e::blue || r1.hello_world != "hello, man");
+  file.close();
+  std::filesystem::remove(path);
+
+  // corrupted size in header, bool and enum bytes
+  auto corrupted = [&](std::size_t offset, auto value) {
+    std::vector<char> c = snapshot;
+    std::memcpy(c.data() + offset, &value, sizeof(value));
+    return clinok::restore_snapshot<cli1::cli_t>(c, r1, rp1);
+  };
+  constexpr std::size_t size_offset = offsetof(clinok::noexport::snapshot_header, size);
+  for (std::uint64_t size : {std::uint64_t(0), sizeof(clinok::noexport::snapshot_header) - 1})
+    error_if(corrupted(size_offset, size) != snapshot_errc::not_a_snapshot);
+  error_if(corrupted(snapshot_value_offset<cli1::cli_t>(o1, "works"), char(2)) !=
+           snapshot_errc::not_a_snapshot);
+  error_if(corrupted(snapshot_value_offset<cli1::cli_t>(o1, "color"), int(4)) !=
+           snapshot_errc::not_a_snapshot);
+  error_if(corrupted(snapshot_value_offset<cli1::cli_t>(o1, "color"), int(3)) != snapshot_errc::ok ||
+           r1.color != cli1::color_e::yellow);
+  // bit after last option
+  const std::size_t last_word_offset = sizeof(clinok::noexport::snapshot_header) +
+                                       (clinok::options_count<cli1::cli_t>() - 1) / 64 * 8;
+  error_if(corrupted(last_word_offset, std::uint64_t(1) << 63) != snapshot_errc::not_a_snapshot);
+
+  // padding of presented_options after 'myint' counter is not written
+  using presented1 = cli1::cli_t::presented_options;
+  static_assert(std::is_trivially_copyable_v<presented1> &&
+                sizeof(presented1) > offsetof(presented1, myint) + 1);
+  presented1 dirty;
+  std::memcpy(&dirty, &p1, sizeof(dirty));
+  std::memset(reinterpret_cast<char*>(&dirty) + offsetof(presented1, myint) + 1, 0xAB,
+              sizeof(dirty) - offsetof(presented1, myint) - 1);
+  error_if(clinok::save_snapshot<cli1::cli_t>(o1, dirty) != snapshot);
+}
+
+void test_to_args() {
+  // enum, renamed option, negative integer, string with spaces and custom type
+  const char* argv[] = {"program", "-l", "warn", "-t", "-15", "--user", "a b", "--location", "3", "-4"};
+  clinok::error_code ec;
+  cli3::cli_t::presented_options presented;
+  cli3::options o = clinok::parse<cli3::cli_t>(clinok::args_range(10, argv), presented, ec);
+  error_if(ec);
+  char chars[256];
+  clinok::arg args[16];
+  clinok::args_writer w(chars, args);
+  std::size_t before = allocations_count;
+  error_if(!clinok::to_args<cli3::cli_t>("child", o, w));
+  error_if(allocations_count != before);
+  std::vector<std::string_view> expected = {"child", "--log-level", "warn", "--timeout", "-15",  "--user",
+                                            "a b",   "--location",  "3",    "-4"};
+  error_if(std::vector<std::string_view>(w.args().begin(), w.args().end()) != expected);
+  error_if(args[w.args().size()] != nullptr || w.args_needed() != 11);
+  cli3::cli_t::presented_options reparsed_presented;
+  cli3::options reparsed = clinok::parse<cli3::cli_t>(w.args(), reparsed_presented, ec);
+  error_if(ec || reparsed.log_level != o.log_level || reparsed.timeout != -15 || reparsed.user != "a b");
+  error_if(reparsed.location != Point{3, -4} || reparsed_presented != presented);
+
+  // only presented options, tags and counted occurrences
+  const char* argv1[] = {"program", "--myint2", "1", "-c", "red", "-hh", "2", "--mytag", "--myint", "3"};
+  cli1::cli_t::presented_options p1;
+  cli1::options o1 = clinok::parse<cli1::cli_t>(clinok::args_range(10, argv1), p1, ec);
+  error_if(ec);
+  clinok::args_writer w1(chars, args);
+  error_if(!clinok::to_args<cli1::cli_t>("child", o1, p1, w1));
+  expected = {"child", "--mytag", "--myint", "3", "--myint", "3", "--myint2", "1", "--color", "red"};
+  error_if(std::vector<std::string_view>(w1.args().begin(), w1.args().end()) != expected);
+  cli1::cli_t::presented_options p1_reparsed;
+  o1 = clinok::parse<cli1::cli_t>(w1.args(), p1_reparsed, ec);
+  error_if(ec || p1_reparsed != p1 || !o1.mytag || o1.myint != 3);
+
+  // free arguments, buffers too small
+  const char* argv2[] = {"program", "a", "--hello_world", "x", "--myname", "me", "b"};
+  cli2::options o2 = clinok::parse<cli2::cli_t>(clinok::args_range(7, argv2), ec);
+  error_if(ec);
+  clinok::args_writer small(std::span(chars, 10), args);
+  error_if(clinok::to_args<cli2::cli_t>("child", o2, small) || small.args().size() != 0);
+  std::vector<char> big_chars(small.chars_needed());
+  std::vector<clinok::arg> big_args(small.args_needed());
+  clinok::args_writer big(big_chars, big_args);
+  error_if(!clinok::to_args<cli2::cli_t>("child", o2, big));
+  error_if(big.chars_needed() != big_chars.size() || big_args.back() != nullptr);
+  expected = {"child",  "--works", "false", "--hello_world", "x", "--myname", "me",
+              "--ABC2", "why",     "a",     "b"};
+  error_if(std::vector<std::string_view>(big.args().begin(), big.args().end()) != expected);
+}
+
+void test_out_of_line_definitions() {
+  const char* argv[] = {"program", "-l", "warn", "--user", "me", "--location", "1", "2"};
+  clinok::error_code ec;
+  cli5::options o = cli5::parse(8, const_cast<char**>(argv), ec);
+  error_if(ec || o.log_level != cli5::log_level_e::warn || o.user != "me" || o.location != Point{1, 2});
+  o = cli5::parse(clinok::args_range(3, argv), ec);
+  error_if(ec.what != clinok::errc::required_option_not_present);
+  std::stringstream err;
+  cli5::print_err(ec, err);
+  error_if(err.str().empty());
+
+  std::stringstream help;
+  cli5::print_help_message(help);
+  error_if(help.str().find(" --timeout <int>       default: \"10\", Request timeout in seconds\n") ==
+           std::string::npos);
+  error_if(help.str().find("-l is an alias to log-level") == std::string::npos);
+}
+
+void test_table_driven_parse() {
+  static_assert(clinok::noexport::parse_table_for<cli1_table::cli_t>.options.size() ==
+                clinok::options_count<cli1_table::cli_t>());
+  std::vector<std::vector<const char*>> cmdlines = {
+      {"program", "--myint2", "1", "-c", "red"},
+      {"program", "-i", "-5", "-hh", "5", "--myint", "6", "-c", "blue", "--mytag", "-w", "true", "--help"},
+      {"program", "--hello_world", "x", "--myname", "y", "--ABC2", "z", "-i", "0", "--color", "yellow"},
+      {"program", "--mytga", "-i", "1", "-c", "red"},
+      {"program", "-i", "1", "-c", "purple"},
+      {"program", "-i", "x", "-c", "red"},
+      {"program", "-c", "red", "--myint2"},
+      {"program", "-i", "1"},
+      {"program", "-i", "1", "-c", "red", "free"},
+      {"program", "-", "-i", "1"},
+  };
+  for (auto& cmdline : cmdlines) {
+    clinok::args_t args(cmdline);
+    clinok::error_code ec1, ec2;
+    cli1::cli_t::presented_options p1;
+    cli1_table::cli_t::presented_options p2;
+    cli1::options o1 = clinok::parse<cli1::cli_t>(args, p1, ec1);
+    cli1_table::options o2 = clinok::parse<cli1_table::cli_t>(args, p2, ec2);
+    error_if(ec1.what != ec2.what || ec1.ctx.typed != ec2.ctx.typed);
+    error_if(ec1.ctx.resolved_name != ec2.ctx.resolved_name || ec1.ctx.value != ec2.ctx.value);
+    error_if(p1.bits.words != p2.bits.words || p1.myint != p2.myint);
+    if (ec1)
+      continue;
+    error_if(o1.mytag != o2.mytag || o1.works != o2.works || o1.hello_world != o2.hello_world);
+    error_if(o1.myname != o2.myname || o1.ABC2 != o2.ABC2 || o1.myint != o2.myint);
+    error_if(o1.myint2 != o2.myint2 || int(o1.color) != int(o2.color) || o1.help != o2.help);
+  }
+}
+
+void test_allocation_free_errors() {
+  std::vector<std::vector<const char*>> argvs = {
+      {"program_name_placeholder", "--myint2", "1", "--color", "red"},
+      {"program_name_placeholder", "--myint2", "1", "-c", "black"},
+      {"program_name_placeholder", "--myint2"},
+      {"program_name_placeholder", "--mynt2", "3"},
+      {"program_name_placeholder", "-x"},
+      {"program_name_placeholder", "--myint2", "1"},
+      {"program_name_placeholder", "free_arg"},
+  };
+  std::vector<clinok::error_code> errs(argvs.size());
+  std::size_t before = allocations_count;
+  for (std::size_t i = 0; i < argvs.size(); ++i) {
+    cli1::options o = cli1::parse(clinok::args_range(argvs[i].size(), argvs[i].data()), errs[i]);
+    use(o);
+  }
+  error_if(allocations_count != before);
+  error_if(errs[0] || !errs[1] || !errs[2] || !errs[3] || !errs[4] || !errs[5] || !errs[6]);
+  assert_eq(std::string_view("black"), errs[1].ctx.value);
+
+  // possible values and suggestions are prepared once
+  char buf[256];
+  auto print_to_buf = [&](const clinok::error_code& e) {
+    std::size_t n = 0;
+    cli1::print_err_to(e, [&](auto x) {
+      if constexpr (std::is_same_v<decltype(x), char>)
+        buf[n++] = x;
+      else
+        n += std::string_view(x).copy(buf + n, sizeof(buf) - n);
+    });
+    return std::string_view(buf, n);
+  };
+  (void)print_to_buf(errs[1]);
+  before = allocations_count;
+  std::string_view msg = print_to_buf(errs[1]);
+  error_if(allocations_count != before);
+  error_if(!msg.ends_with("Possible values are: [red, green, blue, yellow]\n"));
+
+  // error outlives arguments
+  clinok::error_code owned;
+  {
+    std::string arg = "--mynt2";
+    std::vector<const char*> argv = {"program_name_placeholder", arg.c_str()};
+    (void)cli1::parse(clinok::args_range(argv.size(), argv.data()), owned);
+    error_if(owned.owns_context());
+    owned.own();
+    arg = "-------";
+  }
+  clinok::error_code copy = owned;
+  clinok::error_code moved = std::move(owned);
+  for (clinok::error_code* e : {&copy, &moved}) {
+    error_if(!e->owns_context() || e->what != clinok::errc::unknown_option);
+    assert_eq(std::string_view("--mynt2"), e->ctx.typed);
+    assert_eq(std::string_view("mynt2"), e->ctx.resolved_name);
+  }
+  // moved-from error_code does not point into moved storage
+  error_if(owned.owns_context() || !owned.ctx.typed.empty());
+  clinok::error_code from_moved = owned;
+  clinok::error_code from_moved2 = std::move(owned);
+  error_if(from_moved.owns_context() || from_moved2.owns_context() || !from_moved2.ctx.typed.empty());
+  copy = moved;
+  assert_eq(std::string_view("--mynt2"), copy.ctx.typed);
+  copy.clear();
+  error_if(copy || copy.owns_context());
+}
+
 void test_select_subprogram(std::vector<const char*> vecargs, std::string_view progname,
                             std::initializer_list<std::string_view> subprogram_names,
                             std::string expected_msg, int expected_index) {
@@ -357,6 +1325,11 @@ struct A9R : A1 {
   };
 };
 
+struct A10R : A1 {
+  using all_options = clinok::typelist<my::pseudooptionA>;
+  static constexpr alias aliases[] = {{"x", "y"}, {"y", "x"}, {"z", "y"}, {"w", "z"}, {"v", "a"}};
+};
+
 void test_resolve_aliases() {
   std::string_view s = clinok::resolve_alias<A9R>("alala");
   assert_eq("", s);
@@ -369,6 +1342,13 @@ void test_resolve_aliases() {
   assert_eq("a", s);
   s = clinok::resolve_alias<A9R>("abc");
   assert_eq("b", s);
+
+  static_assert(clinok::find_alias<A9R>("dd") == 1 && clinok::find_alias<A9R>("fffdd") == 0);
+  static_assert(clinok::find_alias<A9R>("b") == 3 && !clinok::has_alias<A9R>("b"));
+  // cycles are not resolvable
+  static_assert(clinok::has_alias<A10R>("x") && clinok::resolve_alias<A10R>("x") == "");
+  static_assert(clinok::resolve_alias<A10R>("w") == "" && clinok::resolve_alias<A10R>("v") == "a");
+  static_assert(clinok::find_alias<cli1::cli_t>("hh") == clinok::find_option<cli1::cli_t>("myint"));
 }
 
 void test_validate_aliases() {
@@ -430,8 +1410,12 @@ int main() {
   test_resolve_aliases();
   test_validate_aliases();
   test_trim_ws();
+  test_perfect_hash();
   test_split_by_comma();
   test_levenshtein_distance();
+  test_bounded_distance();
+  test_osa_distance();
+  test_suggestion_index();
   test_parse1(
       {
           "program_name_placeholder",
@@ -567,6 +1551,18 @@ int main() {
       clinok::errc::invalid_argument,
       "invalid argument when parsing \"--color\". Possible values are: [red, green, blue, yellow]\n");
 
+  test_parse1(
+      {
+          "program_name_placeholder",
+          "--myint2",
+          "1",
+          "--color",
+          "gren",
+      },
+      clinok::errc::invalid_argument,
+      "invalid argument when parsing \"--color\" you probably meant \"green\". Possible values are: [red, "
+      "green, blue, yellow]\n");
+
   test_parse1(
       {
           "program_name_placeholder",
@@ -668,6 +1664,13 @@ int main() {
   test_parse3({"program_name_placeholder", "-l", "info"}, clinok::errc::required_option_not_present,
               "required option \"user\" is missing\n");
 
+  test_parse3({"program_name_placeholder", "--user", "u", "--log-level", "warm"},
+              clinok::errc::invalid_argument,
+              "invalid argument when parsing \"--log-level\" you probably meant \"warn\"\n");
+  test_parse3({"program_name_placeholder", "-l", "verbose"}, clinok::errc::invalid_argument,
+              "invalid argument when parsing \"-l\" resolved as \"--log-level\". Possible values are: "
+              "[trace, debug, info, warn, error]\n");
+
   test_parse3({"program_name_placeholder", "--timeout"}, clinok::errc::argument_missing,
               "argument missing when parsing \"--timeout\"\n");
 
@@ -688,6 +1691,12 @@ int main() {
   assert_eq(expected_help1, help1);
   assert_eq(expected_help2, help2);
   assert_eq(expected_help3, help3);
+  // help without runtime parts generated at compile time
+  static_assert(clinok::noexport::has_static_help<cli2::cli_t>());
+  static_assert(clinok::noexport::static_help<cli2::cli_t>.str() == expected_help2);
+  static_assert(!clinok::noexport::has_static_help<cli1::cli_t>());
+  static_assert(clinok::noexport::has_static_help<cli3::timeout_o>() &&
+                clinok::noexport::has_static_help<cli3::location_o>());
 
   static_assert(!cli1::cli_t::allow_additional_args && cli2::cli_t::allow_additional_args);
   cli1::options o1;
@@ -699,6 +1708,23 @@ int main() {
   cli2::options o2;
   use(o2.mytag, o2.works, o2.hello_world, o2.myname, o2.ABC2);
 
+  test_parse_batch();
+  test_default_options_image();
+  test_presented_options();
+  test_pull_parser();
+  test_parse_into();
+  test_response_files();
+  test_split_command_line();
+  test_cached_default_value();
+  test_free_args_view();
+  test_parse_layered();
+  test_live_options();
+  test_snapshot();
+  test_to_args();
+  test_out_of_line_definitions();
+  test_table_driven_parse();
+  test_allocation_free_errors();
+
   test_select_subprogram({"git", "status", "abc"}, "git", {"status", "branch"}, "", 0);
   test_select_subprogram({"git", "status", "abc"}, "git", {"branch", "status"}, "", 1);
   test_select_subprogram({"git", "status", "abc"}, "git", {"status"}, "", 0);